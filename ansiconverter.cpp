@@ -0,0 +1,339 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QColor>
+#include <QFile>
+#include <QTextCharFormat>
+#include <QTextCursor>
+#include <QVarLengthArray>
+
+#include <cstring>
+
+#include "ansiconverter.h"
+
+#define MAX_SEQUENCE 256 // longer ones are garbage, not worth waiting for
+
+// same as doc/ansifilter.map
+static const QList<QRgb> defaultPalette = {
+    0x000000, 0xd01717, 0x8cc716, 0xd09217, 0x1793d0, 0xd01792, 0x17d092, 0xcccccc,
+    0x111111, 0xff1c1c, 0x9adb18, 0xffb31c, 0x1cb4ff, 0xff1cb3, 0x1ae6a1, 0xeeeeee
+};
+static QList<QRgb> palette = defaultPalette;
+
+static QRgb color256(int n) {
+    if (n < 16)
+        return palette.at(qMax(0, n));
+    if (n < 232) { // 6x6x6 cube
+        n -= 16;
+        auto level = [](int v) { return v ? 55 + 40*v : 0; };
+        return qRgb(level(n/36), level((n/6)%6), level(n%6));
+    }
+    const int gray = 8 + 10*(qMin(n, 255) - 232);
+    return qRgb(gray, gray, gray);
+}
+
+static void escape(QString &html, QStringView text) {
+    for (const QChar c : text) {
+        switch (c.unicode()) {
+            case '<': html += QLatin1String("&lt;"); break;
+            case '>': html += QLatin1String("&gt;"); break;
+            case '&': html += QLatin1String("&amp;"); break;
+            case '"': html += QLatin1String("&quot;"); break;
+            default: html += c;
+        }
+    }
+}
+
+AnsiConverter::AnsiConverter() : m_decoder(QStringDecoder::System), m_tracking(false) {
+}
+
+bool AnsiConverter::Style::operator==(const Style &other) const {
+    return hasFg == other.hasFg && hasBg == other.hasBg && (!hasFg || fg == other.fg) && (!hasBg || bg == other.bg) &&
+           bold == other.bold && italic == other.italic && underline == other.underline && inverse == other.inverse;
+}
+
+AnsiConverter::Style AnsiConverter::Style::resolved() const {
+    if (!inverse)
+        return *this;
+    Style style = *this;
+    style.fg = hasBg ? bg : palette.at(0);
+    style.bg = hasFg ? fg : palette.at(7);
+    style.hasFg = style.hasBg = true;
+    style.inverse = false;
+    return style;
+}
+
+void AnsiConverter::apply(const Style &style, QTextCharFormat &format) {
+    if (style.hasFg)
+        format.setForeground(QColor(style.fg));
+    if (style.hasBg)
+        format.setBackground(QColor(style.bg));
+    if (style.bold)
+        format.setFontWeight(QFont::Bold);
+    if (style.italic)
+        format.setFontItalic(true);
+    if (style.underline)
+        format.setFontUnderline(true);
+}
+
+void AnsiConverter::flush(const char *data, qsizetype length) {
+    if (length < 1 || m_tracking)
+        return;
+    const qsizetype from = m_text.size();
+    m_text += m_decoder.decode(QByteArrayView(data, length));
+    const qsizetype added = m_text.size() - from;
+    if (added < 1)
+        return;
+    if (!m_spans.isEmpty() && m_spans.last().style == m_style && m_spans.last().from + m_spans.last().length == from)
+        m_spans.last().length += added;
+    else
+        m_spans.append({from, added, m_style});
+}
+
+void AnsiConverter::insert(QTextCursor &cursor, const QByteArray &data) {
+    parse(data);
+    // whatever the previous run looked like, only the font remains
+    QTextCharFormat base = cursor.charFormat();
+    base.clearForeground();
+    base.clearBackground();
+    base.setFontWeight(QFont::Normal);
+    base.setFontItalic(false);
+    base.setFontUnderline(false);
+    cursor.beginEditBlock();
+    for (const Span &span : m_spans) {
+        QTextCharFormat format = base;
+        apply(span.style.resolved(), format);
+        cursor.insertText(m_text.mid(span.from, span.length), format);
+    }
+    cursor.endEditBlock();
+    m_text.clear();
+    m_spans.clear();
+}
+
+void AnsiConverter::parse(const QByteArray &chunk) {
+    QByteArray joined;
+    if (!m_pending.isEmpty()) {
+        joined = m_pending + chunk;
+        m_pending.clear();
+    }
+    const QByteArray &data = joined.isNull() ? chunk : joined;
+    const char *d = data.constData();
+    const qsizetype n = data.size();
+    qsizetype text = 0, i = 0;
+    while (i < n) {
+        if (m_tracking) { // straight to the next sequence
+            const char *esc = static_cast<const char*>(memchr(d + i, 0x1b, n - i));
+            if (!esc)
+                break;
+            i = esc - d;
+        }
+        const uchar c = d[i];
+        if ((c >= 0x20 && c != 0x7f) || c == '\n' || c == '\t') {
+            ++i;
+            continue;
+        }
+        flush(d + text, i - text);
+        if (c != 0x1b) { // other controls, \r, \b etc. are dropped
+            text = ++i;
+            continue;
+        }
+        // find the end of the sequence, -1 if it continues in the next chunk
+        qsizetype end = -1;
+        if (i + 1 < n) {
+            const uchar kind = d[i+1];
+            if (kind == '[') { // CSI, parameters and intermediates up to the final byte
+                qsizetype j = i + 2;
+                while (j < n && uchar(d[j]) >= 0x20 && uchar(d[j]) <= 0x3f)
+                    ++j;
+                while (j < n && uchar(d[j]) >= 0x20 && uchar(d[j]) <= 0x2f)
+                    ++j;
+                if (j < n) {
+                    end = j + 1;
+                    if (d[j] == 'm')
+                        sgr(QByteArrayView(d + i + 2, j - i - 2));
+                }
+            } else if (kind == ']' || kind == 'P' || kind == 'X' || kind == '^' || kind == '_') { // strings until BEL or ST
+                for (qsizetype j = i + 2; j < n; ++j) {
+                    if (d[j] == '\a') {
+                        end = j + 1;
+                        break;
+                    }
+                    if (d[j] == 0x1b && j + 1 < n && d[j+1] == '\\') {
+                        end = j + 2;
+                        break;
+                    }
+                }
+            } else if (kind >= 0x20 && kind <= 0x2f) { // charset selection and alike
+                qsizetype j = i + 1;
+                while (j < n && uchar(d[j]) >= 0x20 && uchar(d[j]) <= 0x2f)
+                    ++j;
+                if (j < n)
+                    end = j + 1;
+            } else {
+                end = i + 2;
+            }
+        }
+        if (end < 0) {
+            if (n - i < MAX_SEQUENCE) {
+                m_pending = data.mid(i);
+                return;
+            }
+            end = i + 2; // garbage, only the introducer is dropped
+        }
+        text = i = end;
+    }
+    flush(d + text, n - text);
+}
+
+void AnsiConverter::setColors(const QString &path) {
+    palette = defaultPalette;
+    if (path.isEmpty())
+        return;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        const int eq = line.indexOf('=');
+        if (eq < 0)
+            continue;
+        bool ok;
+        const int index = line.left(eq).trimmed().toInt(&ok);
+        const QColor color = QColor::fromString(QLatin1String(line.mid(eq + 1).trimmed()));
+        if (ok && index >= 0 && index < 16 && color.isValid())
+            palette[index] = color.rgb() & RGB_MASK;
+    }
+}
+
+void AnsiConverter::sgr(QByteArrayView params) {
+    QVarLengthArray<int, 16> v;
+    int value = 0;
+    for (const char c : params) {
+        if (c >= '0' && c <= '9') {
+            value = qMin(value*10 + c - '0', 0xffff);
+        } else if (c == ';' || c == ':') {
+            v.append(value);
+            value = 0;
+        }
+    }
+    v.append(value); // "\e[m" is "\e[0m"
+    for (qsizetype k = 0; k < v.size(); ++k) {
+        const int p = v.at(k);
+        if (p == 0) {
+            m_style = Style();
+        } else if (p == 1) {
+            m_style.bold = true;
+        } else if (p == 3) {
+            m_style.italic = true;
+        } else if (p == 4) {
+            m_style.underline = true;
+        } else if (p == 7) {
+            m_style.inverse = true;
+        } else if (p == 22) {
+            m_style.bold = false;
+        } else if (p == 23) {
+            m_style.italic = false;
+        } else if (p == 24) {
+            m_style.underline = false;
+        } else if (p == 27) {
+            m_style.inverse = false;
+        } else if ((p >= 30 && p <= 37) || (p >= 90 && p <= 97)) {
+            m_style.fg = palette.at(p < 90 ? p - 30 : p - 90 + 8);
+            m_style.hasFg = true;
+        } else if ((p >= 40 && p <= 47) || (p >= 100 && p <= 107)) {
+            m_style.bg = palette.at(p < 100 ? p - 40 : p - 100 + 8);
+            m_style.hasBg = true;
+        } else if (p == 39) {
+            m_style.hasFg = false;
+        } else if (p == 49) {
+            m_style.hasBg = false;
+        } else if (p == 38 || p == 48) {
+            QRgb color;
+            if (k + 2 < v.size() && v.at(k+1) == 5) {
+                color = color256(v.at(k+2));
+                k += 2;
+            } else if (k + 4 < v.size() && v.at(k+1) == 2) {
+                color = qRgb(qMin(v.at(k+2), 255), qMin(v.at(k+3), 255), qMin(v.at(k+4), 255));
+                k += 4;
+            } else {
+                break; // malformed, the rest can't be trusted
+            }
+            if (p == 38) {
+                m_style.fg = color;
+                m_style.hasFg = true;
+            } else {
+                m_style.bg = color;
+                m_style.hasBg = true;
+            }
+        }
+    }
+}
+
+QString AnsiConverter::toHtml(const QByteArray &data) {
+    parse(data);
+    QString html;
+    html.reserve(m_text.size() + 64*m_spans.size());
+    for (const Span &span : m_spans) {
+        const QStringView text = QStringView(m_text).mid(span.from, span.length);
+        if (span.style == Style()) {
+            escape(html, text);
+            continue;
+        }
+        const Style s = span.style.resolved();
+        html += QLatin1String("<span style=\"");
+        if (s.hasFg)
+            html += QLatin1String("color:") + QColor(s.fg).name() + ';';
+        if (s.hasBg)
+            html += QLatin1String("background-color:") + QColor(s.bg).name() + ';';
+        if (s.bold)
+            html += QLatin1String("font-weight:bold;");
+        if (s.italic)
+            html += QLatin1String("font-style:italic;");
+        if (s.underline)
+            html += QLatin1String("text-decoration:underline;");
+        html += QLatin1String("\">");
+        escape(html, text);
+        html += QLatin1String("</span>");
+    }
+    m_text.clear();
+    m_spans.clear();
+    return html;
+}
+
+QString AnsiConverter::toText(const QByteArray &data, QList<QTextLayout::FormatRange> &formats) {
+    parse(data);
+    for (const Span &span : m_spans) {
+        if (span.style == Style())
+            continue;
+        QTextLayout::FormatRange range;
+        range.start = span.from;
+        range.length = span.length;
+        apply(span.style.resolved(), range.format);
+        formats.append(range);
+    }
+    const QString text = m_text;
+    m_text.clear();
+    m_spans.clear();
+    return text;
+}
+
+void AnsiConverter::track(const QByteArray &data) {
+    m_tracking = true;
+    parse(data);
+    m_tracking = false;
+}
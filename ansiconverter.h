@@ -0,0 +1,68 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef ANSICONVERTER_H
+#define ANSICONVERTER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QRgb>
+#include <QString>
+#include <QStringDecoder>
+#include <QTextLayout>
+
+class QTextCursor;
+
+// Turns output with ANSI escape sequences into html or formatted text, chunk by chunk.
+// SGR colors (16, 256 and truecolor), bold, italic, underline and inverse are kept,
+// cursor movement and everything else is dropped. Sequences may span chunks.
+class AnsiConverter {
+public:
+    struct Style { // what the SGR sequences so far make of the next text
+        QRgb fg = 0, bg = 0;
+        bool hasFg = false, hasBg = false;
+        bool bold = false, italic = false, underline = false, inverse = false;
+        bool operator==(const Style &other) const;
+        Style resolved() const; // inverse swapped into the colors
+    };
+    AnsiConverter();
+    void insert(QTextCursor &cursor, const QByteArray &data);
+    void setStyle(const Style &style) { m_style = style; }
+    Style style() const { return m_style; }
+    QString toHtml(const QByteArray &data); // spans are closed at the end of every chunk
+    QString toText(const QByteArray &data, QList<QTextLayout::FormatRange> &formats);
+    void track(const QByteArray &data); // only follows the style, no text
+    static void setColors(const QString &path); // ansifilter style map, "index= #rrggbb", defaults without
+private:
+    struct Span {
+        qsizetype from, length;
+        Style style;
+    };
+    static void apply(const Style &style, QTextCharFormat &format);
+    void flush(const char *data, qsizetype length);
+    void parse(const QByteArray &data);
+    void sgr(QByteArrayView params);
+    QByteArray m_pending; // an unfinished escape sequence
+    QStringDecoder m_decoder;
+    Style m_style;
+    QString m_text;
+    QList<Span> m_spans;
+    bool m_tracking;
+};
+
+#endif // ANSICONVERTER_H
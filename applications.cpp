@@ -0,0 +1,441 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QDir>
+#include <QFileInfo>
+#include <QPixmap>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrent>
+
+#include <cstring>
+
+#include "applications.h"
+#include "fuzzymatcher.h"
+#include "iconloader.h"
+#include "qiq.h"
+
+#define INDEX_MAGIC "QIQA"
+#define INDEX_VERSION 2
+
+// the index is a per-user cache, so native endianess and alignment are fine
+struct AppIndex::Header {
+    char magic[4];
+    quint32 version;
+    quint32 count;
+    quint32 recordOffset;
+    quint32 stringOffset;
+    quint32 stringSize; // in QChars
+};
+
+struct AppIndex::Record {
+    quint32 offset[FieldCount];
+    quint32 length[FieldCount];
+    quint32 flags;
+    quint32 reserved;
+    qint64 mtime; // of the desktop file, to only re-parse what changed
+};
+
+enum RecordFlags { NeedsTerminal = 1, Shadow = 2 };
+
+AppIndex::AppIndex() : m_records(nullptr), m_strings(nullptr), m_count(0) {
+}
+
+bool AppIndex::map(const uchar *data, qint64 size) {
+    m_records = nullptr;
+    m_strings = nullptr;
+    m_count = 0;
+    if (!data || size < qint64(sizeof(Header)))
+        return false;
+    const Header *header = reinterpret_cast<const Header*>(data);
+    if (memcmp(header->magic, INDEX_MAGIC, 4) || header->version != INDEX_VERSION)
+        return false;
+    if (header->recordOffset % alignof(Record) || header->stringOffset % alignof(QChar))
+        return false;
+    if (header->recordOffset + quint64(header->count)*sizeof(Record) > quint64(size) ||
+        header->stringOffset + quint64(header->stringSize)*sizeof(QChar) > quint64(size))
+        return false;
+    const Record *records = reinterpret_cast<const Record*>(data + header->recordOffset);
+    // validate once so string() doesn't have to
+    for (quint32 i = 0; i < header->count; ++i) {
+        for (int f = 0; f < FieldCount; ++f) {
+            if (quint64(records[i].offset[f]) + records[i].length[f] > header->stringSize)
+                return false;
+        }
+    }
+    m_records = records;
+    m_strings = reinterpret_cast<const QChar*>(data + header->stringOffset);
+    m_count = header->count;
+    return true;
+}
+
+bool AppIndex::load(const QString &path) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+    return map(m_file.map(0, m_file.size()), m_file.size());
+}
+
+bool AppIndex::load(const QByteArray &data) {
+    m_buffer = data;
+    return map(reinterpret_cast<const uchar*>(m_buffer.constData()), m_buffer.size());
+}
+
+AppIndex::Entry AppIndex::entry(int i) const {
+    Entry entry;
+    for (int f = 0; f < FieldCount; ++f)
+        entry.field[f] = string(i, Field(f)).toString();
+    entry.mtime = m_records[i].mtime;
+    entry.terminal = m_records[i].flags & NeedsTerminal;
+    entry.shadow = m_records[i].flags & Shadow;
+    return entry;
+}
+
+bool AppIndex::isShadow(int i) const {
+    return m_records[i].flags & Shadow;
+}
+
+qint64 AppIndex::mtime(int i) const {
+    return m_records[i].mtime;
+}
+
+bool AppIndex::needsTerminal(int i) const {
+    return m_records[i].flags & NeedsTerminal;
+}
+
+QStringView AppIndex::string(int i, Field field) const {
+    const Record &r = m_records[i];
+    return QStringView(m_strings + r.offset[field], r.length[field]);
+}
+
+QByteArray AppIndex::serialize(const QList<Entry> &entries) {
+    QList<Record> records(entries.size());
+    QString strings;
+    QHash<QString, quint32> known; // categories, icons and paths repeat a lot
+    for (int i = 0; i < entries.size(); ++i) {
+        const Entry &entry = entries.at(i);
+        Record &r = records[i];
+        for (int f = 0; f < FieldCount; ++f) {
+            const QString &s = entry.field[f];
+            r.length[f] = s.size();
+            auto it = known.constFind(s);
+            if (it != known.constEnd()) {
+                r.offset[f] = *it;
+                continue;
+            }
+            r.offset[f] = strings.size();
+            known.insert(s, r.offset[f]);
+            strings += s;
+        }
+        r.flags = (entry.terminal ? NeedsTerminal : 0) | (entry.shadow ? Shadow : 0);
+        r.reserved = 0;
+        r.mtime = entry.mtime;
+    }
+    Header header;
+    memcpy(header.magic, INDEX_MAGIC, 4);
+    header.version = INDEX_VERSION;
+    header.count = records.size();
+    header.recordOffset = sizeof(Header);
+    header.recordOffset += (alignof(Record) - header.recordOffset % alignof(Record)) % alignof(Record);
+    header.stringOffset = header.recordOffset + records.size()*sizeof(Record);
+    header.stringSize = strings.size();
+    QByteArray data;
+    data.reserve(header.stringOffset + strings.size()*sizeof(QChar));
+    data.append(reinterpret_cast<const char*>(&header), sizeof(Header));
+    data.append(header.recordOffset - sizeof(Header), '\0');
+    data.append(reinterpret_cast<const char*>(records.constData()), records.size()*sizeof(Record));
+    data.append(reinterpret_cast<const char*>(strings.constData()), strings.size()*sizeof(QChar));
+    return data;
+}
+
+bool AppIndex::write(const QString &path, const QByteArray &data) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    // QSaveFile renames into place, so a mapped older index remains valid
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(data);
+    return file.commit();
+}
+
+static QString unescaped(QByteArrayView value) {
+    QString string = QString::fromUtf8(value);
+    if (!string.contains('\\'))
+        return string;
+    QString result;
+    result.reserve(string.size());
+    for (int i = 0; i < string.size(); ++i) {
+        const QChar c = string.at(i);
+        if (c != '\\' || i + 1 == string.size()) {
+            result += c;
+            continue;
+        }
+        switch (string.at(++i).unicode()) {
+            case 's': result += ' '; break;
+            case 'n': result += '\n'; break;
+            case 't': result += '\t'; break;
+            case 'r': result += '\r'; break;
+            case '\\': result += '\\'; break;
+            default: result += c; result += string.at(i); break; // "\;" is for the list splitter
+        }
+    }
+    return result;
+}
+
+// Streams through the [Desktop Entry] group and only picks the keys and locales qiq uses
+static void scanDesktopEntry(AppIndex::Entry &entry, const QByteArray &de_DE, const QByteArray &de) {
+    enum Locality { Untranslated = 0, Language, Country };
+    QByteArray name[3], comment[3], keywords[3], type, exec, icon, path, terminal, categories;
+    entry.shadow = true;
+    QFile file(entry.field[AppIndex::Dir] + QDir::separator() + entry.field[AppIndex::File]);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    bool inGroup = false;
+    while (!file.atEnd()) {
+        const QByteArray buffer = file.readLine();
+        const QByteArrayView line = QByteArrayView(buffer).trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        if (line.startsWith('[')) {
+            if (inGroup)
+                break; // actions and the like are of no interest
+            inGroup = line == "[Desktop Entry]";
+            continue;
+        }
+        if (!inGroup)
+            continue;
+        const qsizetype eq = line.indexOf('=');
+        if (eq < 1)
+            continue;
+        QByteArrayView key = line.first(eq).trimmed();
+        const QByteArrayView value = line.sliced(eq + 1).trimmed();
+        Locality locality = Untranslated;
+        const qsizetype bracket = key.indexOf('[');
+        if (bracket > -1) {
+            if (!key.endsWith(']'))
+                continue;
+            const QByteArrayView locale = key.sliced(bracket + 1, key.size() - bracket - 2);
+            if (locale == de_DE)
+                locality = Country;
+            else if (locale == de)
+                locality = Language;
+            else
+                continue;
+            key = key.first(bracket);
+        }
+        if (key == "Name")
+            name[locality] = value.toByteArray();
+        else if (key == "Comment")
+            comment[locality] = value.toByteArray();
+        else if (key == "Keywords")
+            keywords[locality] = value.toByteArray();
+        else if (locality != Untranslated)
+            continue;
+        else if (key == "Type")
+            type = value.toByteArray();
+        else if (key == "Exec")
+            exec = value.toByteArray();
+        else if (key == "Icon")
+            icon = value.toByteArray();
+        else if (key == "Path")
+            path = value.toByteArray();
+        else if (key == "Terminal")
+            terminal = value.toByteArray();
+        else if (key == "Categories")
+            categories = value.toByteArray();
+    }
+    auto localized = [](const QByteArray *values) {
+        for (int i = Country; i >= Untranslated; --i) {
+            if (!values[i].isEmpty())
+                return unescaped(values[i]);
+        }
+        return QString();
+    };
+    entry.field[AppIndex::Name] = localized(name);
+    entry.field[AppIndex::Exec] = unescaped(exec);
+    // only type and name are mandatory, but if there's no executable, this isn't any useful
+    if (type != "Application" || entry.field[AppIndex::Name].isEmpty() || entry.field[AppIndex::Exec].isEmpty())
+        return;
+    entry.shadow = false;
+    entry.field[AppIndex::Comment] = localized(comment);
+    entry.field[AppIndex::Keywords] = localized(keywords);
+    entry.field[AppIndex::Icon] = unescaped(icon);
+    entry.field[AppIndex::Path] = unescaped(path);
+    entry.field[AppIndex::Categories] = unescaped(categories);
+    entry.terminal = terminal == "true" || terminal == "1";
+    ///@todo mimetype ??
+}
+
+QByteArray AppIndex::update(QSharedPointer<const AppIndex> previous, const QStringList &dirs, const QString &path, const QString &locale) {
+    QHash<QString, int> known;
+    if (previous) {
+        for (int i = 0; i < previous->count(); ++i)
+            known.insert(previous->string(i, File).toString(), i);
+    }
+    QList<Entry> entries;
+    QList<int> dirty;
+    QSet<QString> augmented;
+    for (const QString &dir : dirs) {
+        const QFileInfoList files = QDir(dir).entryInfoList(QStringList() << "*.desktop", QDir::Files|QDir::Readable, QDir::Name);
+        for (const QFileInfo &file : files) {
+            // the first entry wins, even if it's no application
+            if (augmented.contains(file.fileName()))
+                continue;
+            augmented.insert(file.fileName());
+            const qint64 mtime = file.lastModified().toMSecsSinceEpoch();
+            const int i = known.value(file.fileName(), -1);
+            if (i > -1 && previous->mtime(i) == mtime && previous->string(i, Dir) == dir) {
+                entries << previous->entry(i);
+                continue;
+            }
+            Entry entry;
+            entry.field[File] = file.fileName();
+            entry.field[Dir] = dir;
+            entry.mtime = mtime;
+            dirty << entries.size();
+            entries << entry;
+        }
+    }
+    if (!dirty.isEmpty()) {
+        const QByteArray de_DE = locale.toUtf8();
+        const QByteArray de = locale.section('_', 0, 0).toUtf8();
+        QtConcurrent::blockingMap(dirty, [&entries, &de_DE, &de](int i) { scanDesktopEntry(entries[i], de_DE, de); });
+    }
+    const QByteArray data = serialize(entries);
+    if (!write(path, data))
+        QFile::remove(path); // don't leave an outdated index behind
+    return data;
+}
+
+// ==============================================================
+
+AppModel::AppModel(QObject *parent) : QAbstractListModel(parent), m_keys(KeyCount), m_iconSize(0) {
+    m_icons = new IconLoader(this);
+    connect(m_icons, &IconLoader::iconsReady, this, [=]() {
+        // the views only repaint what they show
+        if (!m_order.isEmpty())
+            emit dataChanged(index(0, 0), index(m_order.size() - 1, 0), QList<int>() << Qt::DecorationRole);
+    });
+}
+
+int AppModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid())
+        return 0;
+    return m_order.size();
+}
+
+QStringView AppModel::string(int row, AppIndex::Field field) const {
+    return m_index->string(m_order.at(row), field);
+}
+
+QVariant AppModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_order.size())
+        return QVariant();
+    const int row = index.row();
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::EditRole:
+            return string(row, AppIndex::Name).toString();
+        case Qt::DecorationRole: {
+            // resolving icons is expensive, so only do that for what the view actually asks for
+            const QIcon icon = m_icons->icon(string(row, AppIndex::Icon).toString());
+            return icon.isNull() ? m_dummyIcon : icon;
+        }
+        case Qiq::AppExec:
+            return string(row, AppIndex::Exec).toString();
+        case Qiq::AppComment:
+            return string(row, AppIndex::Comment).toString();
+        case Qiq::AppPath: {
+            const QStringView path = string(row, AppIndex::Path);
+            return path.isEmpty() ? QVariant() : path.toString();
+        }
+        case Qiq::AppNeedsTE:
+            return m_index->needsTerminal(m_order.at(row));
+        case Qiq::AppCategories:
+            return string(row, AppIndex::Categories).toString().split(';');
+        case Qiq::AppKeywords:
+            return string(row, AppIndex::Keywords).toString().split(';');
+        default:
+            return QVariant();
+    }
+}
+
+// same, but the tokens only need to be subsequences of the name or command
+int AppModel::fuzzyScore(int row, const QList<FuzzyMatcher> &foldedTokens) const {
+    if (foldedTokens.isEmpty())
+        return -1;
+    const int record = m_order.at(row);
+    int score = 0;
+    for (const FuzzyMatcher &token : foldedTokens) {
+        int s = token.score(m_keys.key(record, NameKey));
+        if (s < 0 && (s = token.score(m_keys.key(record, ExecKey))) < 0)
+            return -1;
+        score += s;
+    }
+    return score;
+}
+
+// -1 if any token misses, otherwise the rank
+int AppModel::score(int row, const QStringList &foldedTokens) const {
+    if (foldedTokens.isEmpty())
+        return -1;
+    const int record = m_order.at(row);
+    int score = 0;
+    for (const QString &token : foldedTokens) {
+        const QStringView name = m_keys.key(record, NameKey);
+        if (!name.isEmpty()) {
+            if (name.startsWith(token)) { score += 100 + 100*token.length()/name.length(); continue; }
+            if (name.contains(token)) { score += 50 + 50*token.length()/name.length(); continue; }
+        }
+        if (m_keys.key(record, ExecKey).contains(token)) { score += 25; continue; }
+        if (m_keys.key(record, CommentKey).contains(token)) { score += 10; continue; }
+        if (m_keys.key(record, ListKey).contains(token)) continue;
+        return -1;
+    }
+    return score;
+}
+
+void AppModel::setIconSize(int size) {
+    if (size != m_iconSize) {
+        m_iconSize = size;
+        QPixmap dummyPix(m_iconSize, m_iconSize);
+        dummyPix.fill(Qt::transparent);
+        m_dummyIcon = QIcon(dummyPix);
+    }
+    m_icons->setSize(m_iconSize); // the theme might have changed nevertheless
+}
+
+void AppModel::setIndex(QSharedPointer<const AppIndex> index) {
+    beginResetModel();
+    m_index = index;
+    const int count = m_index ? m_index->count() : 0;
+    m_order.clear();
+    m_order.reserve(count);
+    m_keys.clear();
+    m_keys.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        if (!m_index->isShadow(i))
+            m_order << i;
+        m_keys.append(NameKey, m_index->string(i, AppIndex::Name));
+        m_keys.append(ExecKey, m_index->string(i, AppIndex::Exec));
+        m_keys.append(CommentKey, m_index->string(i, AppIndex::Comment));
+        // the tokens never contain the ';' separator, so the lists can be flattened
+        m_keys.append(ListKey, m_index->string(i, AppIndex::Categories).toString() + ';' + m_index->string(i, AppIndex::Keywords).toString());
+    }
+    endResetModel();
+}
@@ -0,0 +1,90 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef APPLICATIONS_H
+#define APPLICATIONS_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QFile>
+#include <QIcon>
+#include <QSharedPointer>
+
+#include "searchtable.h"
+
+// Binary, memory mapped application index
+// A fixed size record per desktop entry which references UTF-16 strings in a shared table,
+// so lookups are QStringViews into the mapped file and loading it costs an mmap, not a parse
+class AppIndex {
+public:
+    enum Field { Name = 0, Exec, Comment, Path, Categories, Keywords, Icon, File, Dir, FieldCount };
+    struct Entry {
+        QString field[FieldCount];
+        qint64 mtime = 0;
+        bool terminal = false;
+        bool shadow = false; // no application, but still hides same named entries in later dirs
+    };
+    AppIndex();
+    int count() const { return m_count; }
+    Entry entry(int i) const;
+    bool isShadow(int i) const;
+    bool load(const QString &path);
+    bool load(const QByteArray &data);
+    qint64 mtime(int i) const;
+    bool needsTerminal(int i) const;
+    QStringView string(int i, Field field) const;
+    static QByteArray serialize(const QList<Entry> &entries);
+    static QByteArray update(QSharedPointer<const AppIndex> previous, const QStringList &dirs, const QString &path, const QString &locale);
+    static bool write(const QString &path, const QByteArray &data);
+private:
+    struct Header;
+    struct Record;
+    bool map(const uchar *data, qint64 size);
+    QFile m_file;
+    QByteArray m_buffer;
+    const Record *m_records;
+    const QChar *m_strings;
+    int m_count;
+};
+
+class FuzzyMatcher;
+class IconLoader;
+
+class AppModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    AppModel(QObject *parent = nullptr);
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int fuzzyScore(int row, const QList<FuzzyMatcher> &foldedTokens) const;
+    int score(int row, const QStringList &foldedTokens) const;
+    void setIconSize(int size);
+    void setIndex(QSharedPointer<const AppIndex> index);
+    QSharedPointer<const AppIndex> appIndex() const { return m_index; }
+private:
+    QStringView string(int row, AppIndex::Field field) const;
+    enum Key { NameKey = 0, ExecKey, CommentKey, ListKey, KeyCount };
+    QSharedPointer<const AppIndex> m_index;
+    SearchTable m_keys; // by record, not by row
+    QList<int> m_order; // row -> record, without the shadows
+    IconLoader *m_icons;
+    QIcon m_dummyIcon;
+    int m_iconSize;
+};
+
+#endif // APPLICATIONS_H
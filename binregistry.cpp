@@ -0,0 +1,212 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "binregistry.h"
+
+#define SNAPSHOT_MAGIC 0x51495142 // QIQB
+#define SNAPSHOT_VERSION 1
+
+static qint64 mtime(const QString &path) {
+    struct stat st;
+    if (stat(QFile::encodeName(path).constData(), &st))
+        return -1;
+    return qint64(st.st_mtim.tv_sec)*1000 + st.st_mtim.tv_nsec/1000000;
+}
+
+static bool lessThan(const QString &a, const QString &b) {
+    return a.compare(b, Qt::CaseInsensitive) < 0;
+}
+
+static inline QString filePath(const QString &dir, const QString &name) {
+    return dir + '/' + name;
+}
+
+BinRegistry::BinRegistry() : m_dirty(false) {
+}
+
+bool BinRegistry::load(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_5);
+    quint32 magic, version, count;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION)
+        return false;
+    QHash<QString, Dir> dirs;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString dirPath;
+        Dir dir;
+        stream >> dirPath >> dir.mtime >> dir.entries;
+        dirs.insert(dirPath, dir);
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+    m_dirs = dirs;
+    m_dirty = false;
+    return true;
+}
+
+void BinRegistry::read(const QString &path, Dir &dir) {
+    dir.entries.clear();
+    dir.mtime = mtime(path); // before the listing, so changes during it are caught next time
+    DIR *d = opendir(QFile::encodeName(path).constData());
+    if (!d)
+        return;
+    const int fd = dirfd(d);
+    while (const dirent *entry = readdir(d)) {
+        if (entry->d_name[0] == '.' || entry->d_type == DT_DIR)
+            continue; // hidden, like QDir::entryList w/o QDir::Hidden
+        // links and unknown types need the target anyway and regular files the mode
+        struct stat st;
+        if (fstatat(fd, entry->d_name, &st, 0) || !S_ISREG(st.st_mode) || !(st.st_mode & (S_IXUSR|S_IXGRP|S_IXOTH)))
+            continue;
+        dir.entries.insert(QFile::decodeName(entry->d_name));
+    }
+    closedir(d);
+}
+
+void BinRegistry::prefixRange(QStringView prefix, int &first, int &last) const {
+    const auto begin = std::lower_bound(m_names.cbegin(), m_names.cend(), prefix, [](const QString &name, QStringView prefix) {
+        return QStringView(name).compare(prefix, Qt::CaseInsensitive) < 0;
+    });
+    const auto end = std::upper_bound(begin, m_names.cend(), prefix, [](QStringView prefix, const QString &name) {
+        return prefix.compare(QStringView(name).left(prefix.size()), Qt::CaseInsensitive) < 0;
+    });
+    first = begin - m_names.cbegin();
+    last = end - m_names.cbegin();
+}
+
+bool BinRegistry::rescan(const QString &dir) {
+    const int position = m_order.indexOf(dir);
+    if (position < 0)
+        return false;
+    const QSet<QString> old = m_dirs.value(dir).entries;
+    Dir &current = m_dirs[dir];
+    read(dir, current);
+    m_dirty = true;
+    bool changed = false;
+    for (const QString &name : old) {
+        if (current.entries.contains(name) || m_paths.value(name) != filePath(dir, name))
+            continue;
+        // this was the one in use, is there another one further down $PATH?
+        QString replacement;
+        for (int i = position + 1; i < m_order.size() && replacement.isNull(); ++i) {
+            if (m_dirs.value(m_order.at(i)).entries.contains(name))
+                replacement = filePath(m_order.at(i), name);
+        }
+        if (!replacement.isNull() || m_aliases.contains(name)) {
+            m_paths.insert(name, replacement);
+            continue;
+        }
+        m_paths.remove(name);
+        // "Foo" and "foo" are equal in the order, so look for the exact one
+        for (auto it = std::lower_bound(m_names.begin(), m_names.end(), name, lessThan);
+                  it != m_names.end() && !lessThan(name, *it); ++it) {
+            if (*it == name) {
+                m_names.erase(it);
+                break;
+            }
+        }
+        changed = true;
+    }
+    for (const QString &name : std::as_const(current.entries)) {
+        if (old.contains(name))
+            continue;
+        const auto known = m_paths.constFind(name);
+        if (known == m_paths.cend()) {
+            m_paths.insert(name, filePath(dir, name));
+            m_names.insert(std::lower_bound(m_names.begin(), m_names.end(), name, lessThan), name);
+            changed = true;
+            continue;
+        }
+        // shadows the present one if that's an alias or further down $PATH
+        const QString owner = known->isEmpty() ? QString() : known->chopped(name.size() + 1);
+        if (owner.isNull() || m_order.indexOf(owner) > position)
+            m_paths.insert(name, filePath(dir, name));
+    }
+    return changed;
+}
+
+void BinRegistry::resolve() {
+    m_paths.clear();
+    for (const QString &dir : std::as_const(m_order)) {
+        for (const QString &name : std::as_const(m_dirs[dir].entries)) {
+            if (!m_paths.contains(name)) // the first one in $PATH wins
+                m_paths.insert(name, filePath(dir, name));
+        }
+    }
+    for (const QString &alias : std::as_const(m_aliases)) {
+        if (!m_paths.contains(alias))
+            m_paths.insert(alias, QString());
+    }
+    m_names = m_paths.keys();
+    std::sort(m_names.begin(), m_names.end(), lessThan);
+}
+
+bool BinRegistry::save(const QString &path) {
+    if (!m_dirty)
+        return true;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_5);
+    stream << quint32(SNAPSHOT_MAGIC) << quint32(SNAPSHOT_VERSION) << quint32(m_dirs.size());
+    for (auto it = m_dirs.cbegin(); it != m_dirs.cend(); ++it)
+        stream << it.key() << it->mtime << it->entries;
+    if (!file.commit())
+        return false;
+    m_dirty = false;
+    return true;
+}
+
+void BinRegistry::scan(const QStringList &dirs, const QStringList &aliases) {
+    m_order = dirs;
+    m_aliases = QSet<QString>(aliases.cbegin(), aliases.cend());
+    for (const QString &dir : dirs) {
+        Dir &known = m_dirs[dir];
+        const qint64 t = mtime(dir);
+        if (t < 0 || t != known.mtime) {
+            read(dir, known);
+            m_dirty = true;
+        }
+    }
+    for (auto it = m_dirs.begin(); it != m_dirs.end();) {
+        if (dirs.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_dirs.erase(it); // no longer in $PATH
+            m_dirty = true;
+        }
+    }
+    resolve();
+}
@@ -0,0 +1,58 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef BINREGISTRY_H
+#define BINREGISTRY_H
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+// The executables in $PATH and the aliases
+// Hashed for the "is this a command" checks, paths resolved in $PATH order
+// Tracked per directory, so a change only re-reads that one, and the listings can be
+// stored in a snapshot which is only re-read where the directory mtime changed
+// The names are sorted case insensitive, so all completions of a prefix are one range
+class BinRegistry {
+public:
+    BinRegistry();
+    bool contains(const QString &name) const { return m_paths.contains(name); }
+    bool load(const QString &path);
+    QStringList names() const { return m_names; } // sorted, case insensitive
+    QString path(const QString &name) const { return m_paths.value(name); } // empty for aliases
+    // the names that begin with the prefix (case insensitive) are names().mid(first, last - first)
+    void prefixRange(QStringView prefix, int &first, int &last) const;
+    bool rescan(const QString &dir); // true if the names changed
+    bool save(const QString &path);
+    void scan(const QStringList &dirs, const QStringList &aliases);
+private:
+    struct Dir {
+        qint64 mtime = -1;
+        QSet<QString> entries;
+    };
+    static void read(const QString &path, Dir &dir);
+    void resolve();
+    QHash<QString, Dir> m_dirs;
+    QStringList m_order; // $PATH
+    QSet<QString> m_aliases;
+    QHash<QString, QString> m_paths;
+    QStringList m_names;
+    bool m_dirty; // not in the snapshot
+};
+
+#endif // BINREGISTRY_H
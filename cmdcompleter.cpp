@@ -0,0 +1,220 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QDir>
+#include <QProcess>
+
+#include <QtDebug>
+
+#include "cmdcompleter.h"
+
+#define MAX_FAILURES 3 // then fall back to a process per request
+#define HUNG_TIMEOUT 30000 // owing answers and silent for that long, the server is stuck
+#define CACHE_SIZE 64 // answers
+#define CACHE_TTL 60000 // ms, package lists, systemd units etc. don't change that often
+
+CmdCompleter::CmdCompleter(QObject *parent) : QObject(parent), m_server(nullptr), m_process(nullptr),
+                                              m_persistent(false), m_pending(false), m_failures(0) {
+    m_cache.setMaxCost(CACHE_SIZE);
+}
+
+// kill() but don't wait for it, QProcess would block in its destructor
+static void dispose(QProcess *process) {
+    if (process->state() == QProcess::NotRunning) {
+        process->deleteLater();
+        return;
+    }
+    QObject::connect(process, &QProcess::finished, process, &QObject::deleteLater);
+    process->kill();
+}
+
+CmdCompleter::~CmdCompleter() {
+    cancel();
+    stop();
+}
+
+void CmdCompleter::cancel() {
+    if (m_process) {
+        m_process->disconnect(this);
+        dispose(m_process);
+        m_process = nullptr;
+        m_processBuffer.clear();
+    } else if (m_pending) {
+        // the server answers in order, that one is only cached
+        if (m_discarded.isEmpty())
+            m_late = m_answer;
+        m_discarded << m_key;
+    }
+    setPending(false);
+}
+
+void CmdCompleter::failed() {
+    const bool wasPending = m_pending;
+    stop();
+    setPending(false);
+    if (++m_failures < MAX_FAILURES)
+        start();
+    else
+        qWarning() << "qiq: giving up on the completion server" << m_command;
+    if (wasPending)
+        emit completed(QStringList(), true);
+}
+
+void CmdCompleter::finish() {
+    if (m_pending)
+        m_cache.insert(m_key, new Answer{m_answer, QDeadlineTimer(CACHE_TTL)});
+    m_answer.clear();
+    setPending(false);
+    emit completed(QStringList(), true);
+}
+
+void CmdCompleter::read(QProcess *process, bool terminated) {
+    QByteArray &buffer = terminated ? m_serverBuffer : m_processBuffer;
+    buffer += process->readAllStandardOutput();
+    if (terminated)
+        m_serverQuiet.start();
+    QStringList completions;
+    bool done = false;
+    int from = 0;
+    for (int end; (end = buffer.indexOf('\n', from)) > -1; from = end + 1) {
+        const QByteArrayView line(buffer.constData() + from, end - from);
+        if (terminated && line.size() == 1 && line.at(0) == '\0') {
+            m_failures = 0; // alive, if slow
+            if (!m_discarded.isEmpty()) { // too late, but the next Tab might want it
+                m_cache.insert(m_discarded.takeFirst(), new Answer{m_late, QDeadlineTimer(CACHE_TTL)});
+                m_late.clear();
+                continue;
+            }
+            done = true;
+            from = end + 1;
+            break; // the server has no more lines, there's no next request yet
+        }
+        if (terminated && !m_discarded.isEmpty())
+            m_late << QString::fromLocal8Bit(line);
+        else if (m_pending)
+            completions << QString::fromLocal8Bit(line);
+    }
+    buffer.remove(0, from);
+    if (!completions.isEmpty()) {
+        m_answer << completions;
+        emit completed(completions, false);
+    }
+    if (done)
+        finish();
+}
+
+void CmdCompleter::request(const QString &line) {
+    cancel();
+    if (m_command.isEmpty())
+        return;
+    if (m_server && !m_discarded.isEmpty() && m_serverQuiet.hasExpired(HUNG_TIMEOUT))
+        failed(); // nothing for ages, the next answer would never come
+    m_key = QDir::currentPath() + '\n' + line;
+    m_answer.clear();
+    if (const Answer *answer = m_cache.object(m_key)) {
+        if (!answer->expiry.hasExpired()) {
+            emit completed(answer->completions, false);
+            emit completed(QStringList(), true);
+            return;
+        }
+        m_cache.remove(m_key);
+    }
+    if (m_persistent && m_failures < MAX_FAILURES && (!m_server || m_server->state() == QProcess::NotRunning))
+        start(); // might fail right away, until it's given up
+    setPending(true);
+    if (m_server) {
+        m_server->write(line.toLocal8Bit() + '\n'); // buffered if it's still starting
+        return;
+    }
+    m_process = new QProcess(this);
+    m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, [=]() { read(m_process, false); });
+    connect(m_process, &QProcess::finished, this, [=]() {
+        read(m_process, false);
+        if (!m_processBuffer.isEmpty()) { // no trailing newline
+            m_answer << QString::fromLocal8Bit(m_processBuffer);
+            emit completed(QStringList() << m_answer.constLast(), false);
+        }
+        m_processBuffer.clear();
+        m_process->deleteLater();
+        m_process = nullptr;
+        finish();
+    });
+    connect(m_process, &QProcess::errorOccurred, this, [=](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            cancel();
+            emit completed(QStringList(), true);
+        }
+    });
+    m_process->start(m_command, QStringList() << line);
+}
+
+void CmdCompleter::setCommand(const QString &command, bool persistent) {
+    if (command == m_command && persistent == m_persistent)
+        return;
+    cancel();
+    stop();
+    m_command = command;
+    m_persistent = persistent;
+    m_failures = 0;
+    m_cache.clear();
+    if (m_persistent && !m_command.isEmpty())
+        start(); // warm it up, compinit takes a while
+}
+
+void CmdCompleter::setPending(bool pending) {
+    if (pending == m_pending)
+        return;
+    m_pending = pending;
+    emit pendingChanged(pending);
+}
+
+void CmdCompleter::start() {
+    stop(); // always a fresh process, nothing of the old one's output may get mixed in
+    QProcess *server = m_server = new QProcess(this);
+    server->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    connect(server, &QProcess::readyReadStandardOutput, this, [=]() { read(server, true); });
+    auto died = [=]() { // on its own, try to have it ready for the next request
+        if (m_pending) {
+            setPending(false);
+            emit completed(QStringList(), true);
+        }
+        if (++m_failures < MAX_FAILURES)
+            start();
+        else
+            stop();
+    };
+    connect(server, &QProcess::finished, this, died);
+    connect(server, &QProcess::errorOccurred, this, [=](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            died();
+    });
+    m_serverQuiet.start();
+    server->start(m_command, QStringList() << "--server");
+}
+
+void CmdCompleter::stop() {
+    m_serverBuffer.clear();
+    m_discarded.clear();
+    m_late.clear();
+    if (!m_server)
+        return;
+    m_server->disconnect(this);
+    dispose(m_server);
+    m_server = nullptr;
+}
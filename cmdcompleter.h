@@ -0,0 +1,79 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef CMDCOMPLETER_H
+#define CMDCOMPLETER_H
+
+#include <QCache>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+
+class QProcess;
+
+// The external command completion
+// Either started for every request with the command line as argument or, if persistent,
+// started once with --server, taking one command line per line on stdin and answering
+// with the completions, one per line, terminated by a line that's just a null byte.
+// The server is restarted if it dies or owes answers and stays silent for long. If that keeps
+// happening it's given up and the completer started per request instead.
+// Requests don't block and take as long as they take, the completions are passed on as they
+// come in and a new request or cancel() drops what's still outstanding.
+// Complete answers are cached for a while by command line and working directory, the server's
+// late answers to cancelled requests as well.
+class CmdCompleter : public QObject {
+    Q_OBJECT
+public:
+    CmdCompleter(QObject *parent = nullptr);
+    ~CmdCompleter();
+    void cancel();
+    void clearCache() { m_cache.clear(); }
+    bool isEmpty() const { return m_command.isEmpty(); }
+    bool isPending() const { return m_pending; }
+    void request(const QString &line);
+    void setCommand(const QString &command, bool persistent);
+signals:
+    void completed(const QStringList &completions, bool done); // done comes last, also on failure
+    void pendingChanged(bool pending);
+private:
+    struct Answer {
+        QStringList completions;
+        QDeadlineTimer expiry;
+    };
+    void failed();
+    void finish();
+    void read(QProcess *process, bool terminated);
+    void setPending(bool pending);
+    void start();
+    void stop();
+    QProcess *m_server, *m_process; // the latter per request
+    QString m_command;
+    QByteArray m_serverBuffer, m_processBuffer; // incomplete lines
+    QElapsedTimer m_serverQuiet; // since the server last said something
+    QCache<QString, Answer> m_cache;
+    QString m_key; // of the pending request
+    QStringList m_answer; // so far
+    QStringList m_discarded; // keys of the cancelled requests the server still answers
+    QStringList m_late; // its answer to the first of them, so far
+    bool m_persistent;
+    bool m_pending;
+    int m_failures; // in a row
+};
+
+#endif // CMDCOMPLETER_H
@@ -0,0 +1,216 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QSet>
+
+#include <algorithm>
+#include <cstring>
+
+#include "csvmodel.h"
+#include "outputbuffer.h"
+
+#define INDEX_SLICE (1<<20)
+#define MAX_LINE (1<<16) // bytes, what's beyond is cut
+#define SNIFF_LINES 64
+#define SNIFF_ROWS 4 // below the header, fewer are no evidence for a table
+#define MAX_TITLE 64 // characters, longer isn't a column title
+
+static QStringList split(const QByteArray &line, char separator) {
+    QStringList fields;
+    QByteArray field;
+    const bool quotes = separator == ','; // TSV has none
+    bool quoted = false;
+    for (qsizetype i = 0; i < line.size(); ++i) {
+        const char c = line.at(i);
+        if (quoted) {
+            if (c != '"')
+                field += c;
+            else if (i + 1 < line.size() && line.at(i+1) == '"')
+                field += line.at(++i);
+            else
+                quoted = false;
+        } else if (c == '"' && quotes && field.isEmpty()) {
+            quoted = true;
+        } else if (c == separator) {
+            fields << QString::fromUtf8(field);
+            field.clear();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields << QString::fromUtf8(field);
+    return fields;
+}
+
+static bool isNumber(const QString &field) {
+    bool ok;
+    field.trimmed().toDouble(&ok);
+    return ok;
+}
+
+CsvModel::CsvModel(QObject *parent) : QAbstractTableModel(parent), m_indexed(0), m_filtered(false), m_separator(','), m_fields(1024) {
+}
+
+bool CsvModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && !m_filtered && m_buffer && m_indexed < m_buffer->size();
+}
+
+int CsvModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_header.size();
+}
+
+QVariant CsvModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+    return fields(m_filtered ? m_rows.at(index.row()) : index.row() + 1).value(index.column());
+}
+
+void CsvModel::fetchMore(const QModelIndex &parent) {
+    if (!canFetchMore(parent))
+        return;
+    QList<qint64> lines;
+    qint64 indexed = m_indexed;
+    index(lines, indexed);
+    const int before = rowCount();
+    const int after = lineCount(m_lines.size() + lines.size(), lines.isEmpty() ? m_lines.last() : lines.last(), indexed) - 1;
+    if (after > before)
+        beginInsertRows(QModelIndex(), before, after - 1);
+    m_lines += lines;
+    m_indexed = indexed;
+    if (after > before)
+        endInsertRows();
+}
+
+QStringList CsvModel::fields(int line) const {
+    if (const QStringList *cached = m_fields.object(line))
+        return *cached;
+    const qint64 from = m_lines.at(line);
+    const qint64 to = line + 1 < m_lines.size() ? m_lines.at(line + 1) - 1 : m_indexed;
+    const QStringList fields = split(m_buffer->read(from, qMin(to - from, qint64(MAX_LINE))), m_separator);
+    m_fields.insert(line, new QStringList(fields));
+    return fields;
+}
+
+QVariant CsvModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+    return m_header.value(section);
+}
+
+void CsvModel::index(QList<qint64> &lines, qint64 &indexed) const {
+    const QByteArray slice = m_buffer->read(indexed, INDEX_SLICE);
+    const char *d = slice.constData();
+    qsizetype from = 0;
+    while (const char *nl = static_cast<const char*>(memchr(d + from, '\n', slice.size() - from))) {
+        from = nl - d + 1;
+        lines << indexed + from;
+    }
+    indexed += slice.size();
+}
+
+int CsvModel::lineCount(qsizetype starts, qint64 last, qint64 indexed) const {
+    // the last line counts once it's known to be complete, but not if it's empty
+    return starts - 1 + (indexed == m_buffer->size() && last < indexed ? 1 : 0);
+}
+
+int CsvModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid() || !m_buffer)
+        return 0;
+    if (m_filtered)
+        return m_rows.size();
+    return qMax(0, lineCount(m_lines.size(), m_lines.last(), m_indexed) - 1);
+}
+
+void CsvModel::setBuffer(QSharedPointer<OutputBuffer> buffer, char separator) {
+    beginResetModel();
+    m_buffer = buffer;
+    m_separator = separator;
+    m_lines = {0};
+    m_indexed = 0;
+    m_rows.clear();
+    m_filtered = false;
+    m_header.clear();
+    m_fields.clear();
+    if (m_buffer) {
+        index(m_lines, m_indexed);
+        m_header = fields(0);
+    }
+    endResetModel();
+}
+
+void CsvModel::setFilter(const QString &filter) {
+    if (!m_buffer)
+        return;
+    beginResetModel();
+    m_filtered = !filter.isEmpty();
+    m_rows.clear();
+    if (m_filtered) {
+        while (m_indexed < m_buffer->size())
+            index(m_lines, m_indexed);
+        const int lines = lineCount(m_lines.size(), m_lines.last(), m_indexed);
+        m_buffer->search(filter.toUtf8(), filter != filter.toLower(), m_lines.value(1, m_indexed), m_indexed, [&](qint64 hit) -> qint64 {
+            const int line = std::upper_bound(m_lines.cbegin(), m_lines.cend(), hit) - m_lines.cbegin() - 1;
+            if (line >= lines)
+                return -1;
+            m_rows << line;
+            return line + 1 < m_lines.size() ? m_lines.at(line + 1) : m_indexed;
+        });
+    }
+    endResetModel();
+}
+
+char CsvModel::sniff(const QByteArray &head, bool complete) {
+    if (head.contains("\e["))
+        return 0;
+    QList<QByteArray> lines = head.split('\n');
+    if (!complete || lines.last().isEmpty())
+        lines.removeLast(); // cut off or after the last newline
+    if (lines.size() > SNIFF_LINES)
+        lines.resize(SNIFF_LINES);
+    if (lines.size() < SNIFF_ROWS + 1)
+        return 0;
+    for (const char separator : {'\t', ','}) {
+        const QStringList header = split(lines.first(), separator);
+        const qsizetype columns = header.size();
+        if (columns < 2)
+            continue;
+        QList<QStringList> rows;
+        for (qsizetype i = 1; i < lines.size(); ++i) {
+            rows << split(lines.at(i), separator);
+            if (rows.last().size() != columns)
+                break;
+        }
+        if (rows.last().size() != columns)
+            continue;
+        // the first line has to look like a header, short and distinct titles that aren't data
+        if (QSet<QString>(header.cbegin(), header.cend()).size() != columns ||
+            std::any_of(header.cbegin(), header.cend(), [](const QString &title) {
+                return title.trimmed().isEmpty() || title.size() > MAX_TITLE || isNumber(title); }))
+            continue;
+        // two columns are just as likely "key,value" lines, unless one of them holds numbers
+        if (columns == 2) {
+            bool numbers = false;
+            for (int c = 0; c < 2 && !numbers; ++c)
+                numbers = std::all_of(rows.cbegin(), rows.cend(), [=](const QStringList &row) { return isNumber(row.at(c)); });
+            if (!numbers)
+                continue;
+        }
+        return separator;
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef CSVMODEL_H
+#define CSVMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QList>
+#include <QSharedPointer>
+#include <QStringList>
+
+class OutputBuffer;
+
+// CSV or TSV output as a table, the first line is the header.
+// Only the line offsets are indexed (as far as the view scrolls), rows are split when shown.
+// Quoted fields with line breaks aren't supported, every line is a row.
+// sniff() only takes it for a table if the first line looks like a header and at least four
+// rows below it have as many columns.
+class CsvModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    CsvModel(QObject *parent = nullptr);
+    QSharedPointer<OutputBuffer> buffer() const { return m_buffer; }
+    bool canFetchMore(const QModelIndex &parent) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    void setBuffer(QSharedPointer<OutputBuffer> buffer, char separator = ',');
+    void setFilter(const QString &filter); // rows that contain it
+    static char sniff(const QByteArray &head, bool complete); // the separator, 0 if it's neither
+private:
+    QStringList fields(int line) const;
+    void index(QList<qint64> &lines, qint64 &indexed) const;
+    int lineCount(qsizetype starts, qint64 last, qint64 indexed) const;
+    QSharedPointer<OutputBuffer> m_buffer;
+    QList<qint64> m_lines; // where they start
+    qint64 m_indexed;
+    QList<int> m_rows; // the lines that pass the filter
+    bool m_filtered;
+    QStringList m_header;
+    char m_separator;
+    mutable QCache<int, QStringList> m_fields;
+};
+
+#endif // CSVMODEL_H
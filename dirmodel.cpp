@@ -0,0 +1,146 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QCollator>
+#include <QFile>
+#include <QFileIconProvider>
+#include <QFileSystemWatcher>
+
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "dirmodel.h"
+
+#define CACHE_ENTRIES 100000 // over all cached listings
+
+static qint64 mtime(const QString &path) {
+    struct stat st;
+    if (stat(QFile::encodeName(path).constData(), &st))
+        return -1;
+    return qint64(st.st_mtim.tv_sec)*1000 + st.st_mtim.tv_nsec/1000000;
+}
+
+static const QCollator &collator() {
+    static const QCollator collator = []() {
+        QCollator c;
+        c.setNumericMode(true);
+        c.setCaseSensitivity(Qt::CaseInsensitive);
+        return c;
+    }();
+    return collator;
+}
+
+// like QFileSystemModel: dirs first, "natural" order (templated because DirModel::Entry is private)
+template <typename E> static bool lessThan(const E &a, const E &b) {
+    if (a.dir != b.dir)
+        return a.dir;
+    const int c = collator().compare(a.name, b.name);
+    return c ? c < 0 : a.name < b.name;
+}
+
+DirModel::DirModel(QObject *parent) : QAbstractListModel(parent) {
+    m_cache.setMaxCost(CACHE_ENTRIES);
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &DirModel::update);
+}
+
+QVariant DirModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_entries.size())
+        return QVariant();
+    if (role == Qt::DisplayRole || role == Qt::EditRole)
+        return m_entries.at(index.row()).name;
+    if (role == Qt::DecorationRole) {
+        // the provider is slow and the type specific icons aren't worth it here
+        static const QIcon folder = QFileIconProvider().icon(QFileIconProvider::Folder);
+        static const QIcon file = QFileIconProvider().icon(QFileIconProvider::File);
+        return m_entries.at(index.row()).dir ? folder : file;
+    }
+    return QVariant();
+}
+
+void DirModel::read(const QString &path, Listing &listing) {
+    listing.entries.clear();
+    listing.mtime = mtime(path); // before the listing, so changes during it are caught next time
+    DIR *d = opendir(QFile::encodeName(path).constData());
+    if (!d)
+        return;
+    const int fd = dirfd(d);
+    while (const dirent *entry = readdir(d)) {
+        const char *name = entry->d_name;
+        if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+            continue;
+        bool dir = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+            // only those need a stat to tell whether it's a dir (behind the link)
+            struct stat st;
+            dir = !fstatat(fd, name, &st, 0) && S_ISDIR(st.st_mode);
+        }
+        listing.entries << Entry{QFile::decodeName(name), dir};
+    }
+    closedir(d);
+    std::sort(listing.entries.begin(), listing.entries.end(), lessThan<Entry>);
+}
+
+int DirModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_entries.size();
+}
+
+void DirModel::setRootPath(const QString &path) {
+    if (path == m_rootPath)
+        return;
+    if (!m_rootPath.isEmpty())
+        m_watcher->removePath(m_rootPath);
+    beginResetModel();
+    m_rootPath = path;
+    Listing *listing = m_cache.take(path);
+    if (!listing)
+        listing = new Listing;
+    if (listing->mtime < 0 || listing->mtime != mtime(path))
+        read(path, *listing);
+    m_entries = listing->entries; // shared
+    m_cache.insert(path, listing, qMax(1, int(listing->entries.size())));
+    endResetModel();
+    m_watcher->addPath(path);
+}
+
+void DirModel::update(const QString &path) {
+    if (path != m_rootPath)
+        return;
+    Listing *listing = new Listing;
+    read(path, *listing);
+    const QList<Entry> &fresh = listing->entries;
+    // both are sorted, so walk them side by side and sync the rows
+    int i = 0, j = 0;
+    while (i < m_entries.size() || j < fresh.size()) {
+        if (j == fresh.size() || (i < m_entries.size() && lessThan(m_entries.at(i), fresh.at(j)))) {
+            beginRemoveRows(QModelIndex(), i, i);
+            m_entries.removeAt(i);
+            endRemoveRows();
+        } else if (i == m_entries.size() || lessThan(fresh.at(j), m_entries.at(i))) {
+            beginInsertRows(QModelIndex(), i, i);
+            m_entries.insert(i, fresh.at(j));
+            endInsertRows();
+            ++i; ++j;
+        } else {
+            ++i; ++j;
+        }
+    }
+    m_cache.insert(path, listing, qMax(1, int(fresh.size())));
+}
@@ -0,0 +1,56 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef DIRMODEL_H
+#define DIRMODEL_H
+
+#include <QAbstractListModel>
+#include <QCache>
+
+class QFileSystemWatcher;
+
+// Flat listing of one directory for the path completion
+// Read right away with readdir, entries are only stat'ed if the type isn't known from that.
+// Recent listings are cached and re-used as long as the directory mtime didn't change,
+// only the shown directory is watched and changes there come in as inserted/removed rows.
+class DirModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    DirModel(QObject *parent = nullptr);
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QString rootPath() const { return m_rootPath; }
+    void setRootPath(const QString &path);
+private:
+    struct Entry {
+        QString name;
+        bool dir;
+    };
+    struct Listing {
+        qint64 mtime = -1;
+        QList<Entry> entries; // dirs first, then by name
+    };
+    static void read(const QString &path, Listing &listing);
+    void update(const QString &path);
+    QCache<QString, Listing> m_cache;
+    QList<Entry> m_entries;
+    QFileSystemWatcher *m_watcher;
+    QString m_rootPath;
+};
+
+#endif // DIRMODEL_H
@@ -0,0 +1,228 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QAtomicInt>
+#include <QDeadlineTimer>
+#include <QFile>
+#include <QMutex>
+#include <QRegularExpression>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "filefinder.h"
+
+#define MAX_DEPTH 16
+#define MAX_ENTRIES 200000
+#define TIME_BUDGET 10000 // ms
+
+struct FileFinder::Rule {
+    QRegularExpression pattern;
+    QString base; // the dir of the .gitignore, relative and with trailing slash
+    bool anchored; // matches the path (below base), otherwise the name
+    bool dirOnly;
+    bool negate;
+};
+
+struct FileFinder::Walk {
+    QString root;
+    QDeadlineTimer deadline;
+    QAtomicInt cancelled;
+    QAtomicInt jobs; // still running or queued
+    QAtomicInt entries;
+    QMutex mutex;
+    QStringList batch;
+};
+
+// gitignore globs, "**/" spans dirs, "*" and "?" don't
+static QString globToRegExp(QStringView glob) {
+    QString rx;
+    for (int i = 0; i < glob.size(); ++i) {
+        const QChar c = glob.at(i);
+        if (c == '*') {
+            if (i + 1 < glob.size() && glob.at(i + 1) == '*') {
+                ++i;
+                if (i + 1 < glob.size() && glob.at(i + 1) == '/') {
+                    ++i;
+                    rx += "(?:.*/)?";
+                } else {
+                    rx += ".*";
+                }
+            } else {
+                rx += "[^/]*";
+            }
+        } else if (c == '?') {
+            rx += "[^/]";
+        } else if (c == '[' && glob.indexOf(']', i + 1) > i + 1) {
+            const int end = glob.indexOf(']', i + 1);
+            QString set = glob.mid(i, end - i + 1).toString();
+            if (set.startsWith("[!"))
+                set[1] = '^';
+            rx += set;
+            i = end;
+        } else if (c == '\\' && i + 1 < glob.size()) {
+            rx += QRegularExpression::escape(glob.mid(++i, 1));
+        } else {
+            rx += QRegularExpression::escape(glob.mid(i, 1));
+        }
+    }
+    return QRegularExpression::anchoredPattern(rx);
+}
+
+FileFinder::FileFinder(QObject *parent) : QObject(parent) {
+    m_collector.setInterval(100);
+    connect(&m_collector, &QTimer::timeout, this, &FileFinder::collect);
+}
+
+FileFinder::~FileFinder() {
+    if (m_walk) // no cancel(), nobody wants to hear finished() from here
+        m_walk->cancelled.storeRelaxed(1);
+    m_pool.waitForDone();
+}
+
+void FileFinder::cancel() {
+    if (!m_walk)
+        return;
+    m_walk->cancelled.storeRelaxed(1);
+    m_walk.clear();
+    m_collector.stop();
+    emit finished();
+}
+
+void FileFinder::collect() {
+    if (!m_walk)
+        return;
+    // first, the last job adds its batch before it's done
+    const bool done = !m_walk->jobs.loadAcquire();
+    QStringList batch;
+    {
+        QMutexLocker lock(&m_walk->mutex);
+        batch.swap(m_walk->batch);
+    }
+    if (!batch.isEmpty())
+        emit found(batch);
+    if (done) {
+        m_walk.clear();
+        m_collector.stop();
+        emit finished();
+    }
+}
+
+void FileFinder::readIgnores(const QString &path, const QString &base, Rules &rules) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine());
+        while (line.endsWith('\n') || (line.endsWith(' ') && !line.endsWith("\\ ")))
+            line.chop(1);
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        Rule rule;
+        rule.base = base;
+        rule.negate = line.startsWith('!');
+        if (rule.negate)
+            line.remove(0, 1);
+        rule.dirOnly = line.endsWith('/');
+        if (rule.dirOnly)
+            line.chop(1);
+        rule.anchored = line.contains('/');
+        if (line.startsWith('/'))
+            line.remove(0, 1);
+        if (line.isEmpty())
+            continue;
+        rule.pattern = QRegularExpression(globToRegExp(line));
+        if (rule.pattern.isValid())
+            rules << rule;
+    }
+}
+
+void FileFinder::start(const QString &root) {
+    cancel();
+    m_walk = QSharedPointer<Walk>::create();
+    m_walk->root = root.endsWith('/') ? root : root + '/';
+    m_walk->deadline.setRemainingTime(TIME_BUDGET);
+    m_walk->jobs.storeRelaxed(1);
+    QSharedPointer<const Rules> rules(new Rules);
+    QSharedPointer<Walk> walk = m_walk;
+    m_pool.start([=]() { this->walk(walk, QString(), rules, 0); });
+    m_collector.start();
+}
+
+void FileFinder::walk(QSharedPointer<Walk> walk, const QString &dir, QSharedPointer<const Rules> rules, int depth) {
+    auto done = [&]() { walk->jobs.deref(); };
+    if (walk->cancelled.loadRelaxed() || walk->deadline.hasExpired())
+        return done();
+    const QString path = walk->root + dir;
+    DIR *d = opendir(QFile::encodeName(path).constData());
+    if (!d)
+        return done();
+    // the .gitignore here adds to the ones above
+    if (!faccessat(dirfd(d), ".gitignore", R_OK, 0)) {
+        Rules *more = new Rules(*rules);
+        readIgnores(path + ".gitignore", dir, *more);
+        rules = QSharedPointer<const Rules>(more);
+    }
+    auto ignored = [&](const QString &relative, const QString &name, bool isDir) {
+        bool ignore = false;
+        for (const Rule &rule : *rules) {
+            if ((rule.dirOnly && !isDir) || !relative.startsWith(rule.base))
+                continue;
+            const QString subject = rule.anchored ? relative.mid(rule.base.size()) : name;
+            if (rule.pattern.match(subject).hasMatch())
+                ignore = !rule.negate;
+        }
+        return ignore;
+    };
+    const int fd = dirfd(d);
+    QStringList found;
+    while (const dirent *entry = readdir(d)) {
+        if (entry->d_name[0] == '.')
+            continue; // hidden, also . and .. and .git
+        bool isDir = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            isDir = !fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) && S_ISDIR(st.st_mode);
+        }
+        const QString name = QFile::decodeName(entry->d_name);
+        const QString relative = dir + name;
+        if (!rules->isEmpty() && ignored(relative, name, isDir))
+            continue;
+        if (walk->entries.fetchAndAddRelaxed(1) >= MAX_ENTRIES) {
+            walk->cancelled.storeRelaxed(1); // enough, nobody's going to scroll through that
+            break;
+        }
+        if (isDir) {
+            found << relative + '/';
+            if (depth < MAX_DEPTH) {
+                walk->jobs.ref();
+                const QString sub = relative + '/';
+                m_pool.start([=]() { this->walk(walk, sub, rules, depth + 1); });
+            }
+        } else {
+            found << relative;
+        }
+    }
+    closedir(d);
+    if (!found.isEmpty()) {
+        QMutexLocker lock(&walk->mutex);
+        walk->batch << found;
+    }
+    done();
+}
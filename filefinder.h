@@ -0,0 +1,55 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef FILEFINDER_H
+#define FILEFINDER_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+// Walks the tree below a directory, every directory is listed by its own job in the pool
+// Hidden files and what's in the .gitignore files on the way are skipped, symlinks aren't followed.
+// The walk is limited in depth, entries and time, what's found is passed on in batches
+// as relative paths, directories with a trailing slash.
+class FileFinder : public QObject {
+    Q_OBJECT
+public:
+    FileFinder(QObject *parent = nullptr);
+    ~FileFinder();
+    void cancel();
+    bool isRunning() const { return m_collector.isActive(); }
+    void start(const QString &root);
+signals:
+    void found(const QStringList &paths);
+    void finished(); // also when cancelled
+private:
+    struct Rule;
+    struct Walk;
+    typedef QList<Rule> Rules;
+    void collect();
+    static void readIgnores(const QString &path, const QString &base, Rules &rules);
+    void walk(QSharedPointer<Walk> walk, const QString &dir, QSharedPointer<const Rules> rules, int depth);
+    QThreadPool m_pool;
+    QTimer m_collector;
+    QSharedPointer<Walk> m_walk;
+};
+
+#endif // FILEFINDER_H
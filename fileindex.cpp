@@ -0,0 +1,485 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "fileindex.h"
+
+#define INDEX_MAGIC "QIQL"
+#define INDEX_VERSION 1
+#define BLOCK_SIZE 64 // entries, the first one is stored whole
+#define HOT_DIRS 256 // the most recently changed dirs get watched
+#define HOT_AGE (7*24*3600) // s, older changes don't count
+#define RECRAWL (24*3600*1000) // ms
+
+static QAtomicInt abortCrawl; // we're going down
+
+struct FileIndex::Header {
+    char magic[4];
+    quint32 version;
+    quint32 count;
+    quint32 blockCount;
+    quint32 blockOffset;
+    quint32 dataOffset;
+    quint32 dataSize;
+    quint32 metaOffset; // roots '\0' hot dirs, '\n' separated
+    quint32 metaSize;
+    quint32 reserved;
+    qint64 built;
+};
+
+static inline void appendVarint(QByteArray &data, quint32 v) {
+    while (v > 0x7f) {
+        data.append(char(0x80 | (v & 0x7f)));
+        v >>= 7;
+    }
+    data.append(char(v));
+}
+
+static inline quint32 readVarint(const uchar *&p) {
+    quint32 v = 0;
+    for (int shift = 0; ; shift += 7) {
+        const uchar b = *p++;
+        v |= quint32(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+}
+
+static inline QString indexPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "files.index";
+}
+
+static inline void fold(QByteArray &s) {
+    // ASCII only, paths are bytes
+    for (char &c : s)
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+}
+
+// all tokens in the path, the last one in the file name
+static bool matches(const QByteArray &folded, const QList<QByteArray> &tokens) {
+    qsizetype pos = 0;
+    for (const QByteArray &token : tokens) {
+        if ((pos = folded.indexOf(token, pos)) < 0)
+            return false;
+        pos += token.size();
+    }
+    if (tokens.isEmpty())
+        return true;
+    const qsizetype name = folded.lastIndexOf('/', folded.size() - 2) + 1; // dirs end with '/'
+    return folded.lastIndexOf(tokens.constLast()) >= name;
+}
+
+FileIndex::FileIndex(QObject *parent) : QObject(parent), m_blocks(nullptr), m_data(nullptr), m_dataEnd(nullptr),
+                                        m_count(0), m_blockCount(0), m_built(0), m_watcher(nullptr), m_crawler(nullptr),
+                                        m_search(nullptr), m_nextMax(0) {
+    m_recrawl.setInterval(RECRAWL);
+    connect(&m_recrawl, &QTimer::timeout, this, &FileIndex::crawl);
+}
+
+FileIndex::~FileIndex() {
+    abortCrawl.storeRelaxed(1);
+    if (m_crawler)
+        m_crawler->waitForFinished();
+    settle();
+}
+
+QByteArray FileIndex::build(const QStringList &roots, const QString &path) {
+    QThread::currentThread()->setPriority(QThread::IdlePriority);
+    QList<QByteArray> paths;
+    QList<QPair<qint64, QByteArray>> dirs; // mtime, path
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    QList<QByteArray> todo;
+    for (const QString &root : roots)
+        todo << QFile::encodeName(QDir::cleanPath(root)) + '/';
+    while (!todo.isEmpty()) {
+        if (abortCrawl.loadRelaxed())
+            return QByteArray();
+        const QByteArray dir = todo.takeLast();
+        DIR *d = opendir(dir.constData());
+        if (!d)
+            continue;
+        const int fd = dirfd(d);
+        struct stat st;
+        if (!fstat(fd, &st) && now - st.st_mtim.tv_sec < HOT_AGE)
+            dirs << qMakePair(qint64(st.st_mtim.tv_sec), dir);
+        while (const dirent *entry = readdir(d)) {
+            if (entry->d_name[0] == '.')
+                continue; // hidden, also . and ..
+            bool isDir = entry->d_type == DT_DIR;
+            if (entry->d_type == DT_UNKNOWN)
+                isDir = !fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) && S_ISDIR(st.st_mode);
+            QByteArray child = dir + entry->d_name;
+            if (isDir) {
+                child += '/';
+                todo << child;
+            }
+            paths << child;
+        }
+        closedir(d);
+    }
+    std::sort(paths.begin(), paths.end());
+    std::sort(dirs.begin(), dirs.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    QByteArray data, blocks;
+    const QByteArray *previous = nullptr;
+    for (int i = 0; i < paths.size(); ++i) {
+        const QByteArray &p = paths.at(i);
+        quint32 prefix = 0;
+        if (i % BLOCK_SIZE) {
+            const qsizetype max = qMin(p.size(), previous->size());
+            while (prefix < max && p.at(prefix) == previous->at(prefix))
+                ++prefix;
+        } else {
+            const quint32 offset = data.size();
+            blocks.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        }
+        appendVarint(data, prefix);
+        appendVarint(data, p.size() - prefix);
+        data.append(p.constData() + prefix, p.size() - prefix);
+        previous = &p;
+    }
+    QByteArray meta = QFile::encodeName(roots.join('\n')) + '\0';
+    for (int i = 0; i < dirs.size() && i < HOT_DIRS; ++i)
+        meta += dirs.at(i).second + '\n';
+
+    Header header;
+    memcpy(header.magic, INDEX_MAGIC, 4);
+    header.version = INDEX_VERSION;
+    header.count = paths.size();
+    header.blockCount = blocks.size()/sizeof(quint32);
+    header.blockOffset = sizeof(Header);
+    header.dataOffset = header.blockOffset + blocks.size();
+    header.dataSize = data.size();
+    header.metaOffset = header.dataOffset + data.size();
+    header.metaSize = meta.size();
+    header.reserved = 0;
+    header.built = QDateTime::currentMSecsSinceEpoch();
+    QByteArray index(reinterpret_cast<const char*>(&header), sizeof(Header));
+    index += blocks + data + meta;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(index);
+        file.commit();
+    }
+    return index;
+}
+
+QList<QByteArray> FileIndex::children(const QByteArray &dir) const {
+    QList<QByteArray> list;
+    if (!m_count)
+        return list;
+    // the first block that could hold it, the ones before start with something smaller
+    int lo = 0, hi = m_blockCount;
+    while (hi - lo > 1) {
+        const int mid = (lo + hi)/2;
+        const uchar *p = m_data + m_blocks[mid];
+        readVarint(p);
+        const quint32 length = readVarint(p);
+        if (QByteArrayView(p, length) < QByteArrayView(dir))
+            lo = mid;
+        else
+            hi = mid;
+    }
+    const uchar *p = m_data + m_blocks[lo];
+    QByteArray path;
+    for (int i = lo*BLOCK_SIZE; i < m_count && p < m_dataEnd; ++i) {
+        const quint32 prefix = readVarint(p);
+        const quint32 length = readVarint(p);
+        path.truncate(prefix);
+        path.append(reinterpret_cast<const char*>(p), length);
+        p += length;
+        if (path < dir)
+            continue;
+        if (!path.startsWith(dir))
+            break;
+        const qsizetype slash = path.indexOf('/', dir.size());
+        if (slash < 0 || slash == path.size() - 1) // not deeper
+            list << path;
+    }
+    return list;
+}
+
+void FileIndex::clear() {
+    settle();
+    m_file.close();
+    m_buffer.clear();
+    m_blocks = nullptr;
+    m_data = m_dataEnd = nullptr;
+    m_count = m_blockCount = 0;
+    m_built = 0;
+    m_hot.clear();
+    m_added.clear();
+    m_removed.clear();
+}
+
+void FileIndex::crawl() {
+    if (m_roots.isEmpty() || isCrawling())
+        return;
+    if (!m_crawler) {
+        m_crawler = new QFutureWatcher<QByteArray>(this);
+        connect(m_crawler, &QFutureWatcher<QByteArray>::finished, this, [=]() {
+            if (m_roots.isEmpty())
+                return; // turned off meanwhile
+            // prefer the mapping, the data is the fallback for an unwritable index
+            if (!load(indexPath()))
+                load(m_crawler->result());
+            emit updated();
+        });
+    }
+    static QThreadPool *pool = nullptr;
+    if (!pool) {
+        pool = new QThreadPool(this);
+        pool->setMaxThreadCount(1);
+    }
+    m_crawler->setFuture(QtConcurrent::run(pool, &FileIndex::build, m_roots, indexPath()));
+}
+
+void FileIndex::find(const QStringList &tokens, int max) {
+    if (!m_search) {
+        m_search = new QFutureWatcher<QStringList>(this);
+        connect(m_search, &QFutureWatcher<QStringList>::finished, this, [=]() {
+            if (m_nextMax) { // outdated
+                const int max = m_nextMax;
+                m_nextMax = 0;
+                find(m_nextTokens, max);
+                return;
+            }
+            emit found(m_search->result());
+        });
+    }
+    if (m_search->isRunning()) {
+        m_nextTokens = tokens;
+        m_nextMax = max;
+        return;
+    }
+    static QThreadPool *pool = nullptr;
+    if (!pool) {
+        pool = new QThreadPool(this);
+        pool->setMaxThreadCount(1); // the search itself is spread over the global pool
+    }
+    // the sets change with the watched dirs, the job gets its copy
+    m_search->setFuture(QtConcurrent::run(pool, &FileIndex::search, this, tokens, max, m_added, m_removed));
+}
+
+bool FileIndex::load(const QString &path) {
+    settle();
+    m_file.close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+    m_buffer.clear();
+    return map(m_file.map(0, m_file.size()), m_file.size());
+}
+
+bool FileIndex::load(const QByteArray &data) {
+    settle();
+    m_file.close();
+    m_buffer = data;
+    return map(reinterpret_cast<const uchar*>(m_buffer.constData()), m_buffer.size());
+}
+
+bool FileIndex::map(const uchar *data, qint64 size) {
+    m_blocks = nullptr;
+    m_data = m_dataEnd = nullptr;
+    m_count = m_blockCount = 0;
+    m_built = 0;
+    m_hot.clear();
+    m_added.clear();
+    m_removed.clear();
+    if (!data || size < qint64(sizeof(Header)))
+        return false;
+    Header header;
+    memcpy(&header, data, sizeof(Header));
+    if (memcmp(header.magic, INDEX_MAGIC, 4) || header.version != INDEX_VERSION)
+        return false;
+    if (header.blockOffset % alignof(quint32) || header.blockCount != (header.count + BLOCK_SIZE - 1)/BLOCK_SIZE ||
+        header.blockOffset + quint64(header.blockCount)*sizeof(quint32) > quint64(size) ||
+        header.dataOffset + quint64(header.dataSize) > quint64(size) ||
+        header.metaOffset + quint64(header.metaSize) > quint64(size))
+        return false;
+    const quint32 *blocks = reinterpret_cast<const quint32*>(data + header.blockOffset);
+    for (quint32 b = 0; b < header.blockCount; ++b)
+        if (blocks[b] >= header.dataSize)
+            return false;
+    const QByteArray meta = QByteArray::fromRawData(reinterpret_cast<const char*>(data + header.metaOffset), header.metaSize);
+    const qsizetype split = meta.indexOf('\0');
+    if (split < 0 || QFile::decodeName(meta.left(split)).split('\n') != m_roots)
+        return false; // somebody else's
+    m_blocks = blocks;
+    m_data = data + header.dataOffset;
+    m_dataEnd = m_data + header.dataSize;
+    m_count = header.count;
+    m_blockCount = header.blockCount;
+    m_built = header.built;
+    for (const QByteArray &dir : meta.mid(split + 1).split('\n'))
+        if (!dir.isEmpty())
+            m_hot << QFile::decodeName(dir);
+    // the dirs that change are watched, to keep up between the crawls
+    if (!m_watcher) {
+        m_watcher = new QFileSystemWatcher(this);
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &FileIndex::rescan);
+    }
+    if (!m_watcher->directories().isEmpty())
+        m_watcher->removePaths(m_watcher->directories());
+    if (!m_hot.isEmpty())
+        m_watcher->addPaths(m_hot);
+    for (const QString &dir : std::as_const(m_hot))
+        rescan(dir); // what changed since the crawl
+    return true;
+}
+
+void FileIndex::rescan(const QString &dir) {
+    QByteArray base = QFile::encodeName(dir);
+    if (!base.endsWith('/'))
+        base += '/';
+    QSet<QByteArray> present;
+    if (DIR *d = opendir(base.constData())) {
+        const int fd = dirfd(d);
+        while (const dirent *entry = readdir(d)) {
+            if (entry->d_name[0] == '.')
+                continue;
+            bool isDir = entry->d_type == DT_DIR;
+            struct stat st;
+            if (entry->d_type == DT_UNKNOWN)
+                isDir = !fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) && S_ISDIR(st.st_mode);
+            present << base + entry->d_name + (isDir ? "/" : "");
+        }
+        closedir(d);
+    }
+    const QList<QByteArray> indexed = children(base);
+    for (const QByteArray &path : indexed) {
+        if (present.contains(path))
+            m_removed.remove(path); // back
+        else
+            m_removed.insert(path);
+    }
+    const QSet<QByteArray> known(indexed.cbegin(), indexed.cend());
+    for (auto it = m_added.begin(); it != m_added.end();) {
+        const qsizetype slash = it->startsWith(base) ? it->indexOf('/', base.size()) : 0;
+        if ((slash < 0 || slash == it->size() - 1) && !present.contains(*it))
+            it = m_added.erase(it);
+        else
+            ++it;
+    }
+    for (const QByteArray &path : std::as_const(present))
+        if (!known.contains(path))
+            m_added.insert(path); // new dirs are only crawled with the next run
+}
+
+QStringList FileIndex::search(const QStringList &tokens, int max, const QSet<QByteArray> &added, const QSet<QByteArray> &removed) const {
+    QList<QByteArray> folded;
+    for (const QString &token : tokens) {
+        folded << QFile::encodeName(token);
+        fold(folded.last());
+    }
+    auto test = [&](const QByteArray &path) {
+        QByteArray f = path;
+        fold(f);
+        return matches(f, folded);
+    };
+    // a range of blocks per job
+    QList<QPair<int, int>> ranges;
+    const int step = qMax(16, m_blockCount/(4*QThread::idealThreadCount()));
+    for (int b = 0; b < m_blockCount; b += step)
+        ranges << qMakePair(b, qMin(m_blockCount, b + step));
+    QList<QList<QByteArray>> hits = QtConcurrent::blockingMapped(ranges, [&](const QPair<int, int> &range) {
+        QList<QByteArray> found;
+        const uchar *p = m_data + m_blocks[range.first];
+        const int end = qMin(m_count, range.second*BLOCK_SIZE);
+        QByteArray path;
+        for (int i = range.first*BLOCK_SIZE; i < end && p < m_dataEnd; ++i) {
+            const quint32 prefix = readVarint(p);
+            const quint32 length = readVarint(p);
+            path.truncate(prefix);
+            path.append(reinterpret_cast<const char*>(p), length);
+            p += length;
+            if (test(path) && !removed.contains(path))
+                found << path;
+        }
+        return found;
+    });
+    QList<QByteArray> paths;
+    for (const QList<QByteArray> &h : std::as_const(hits))
+        paths << h;
+    for (const QByteArray &path : added)
+        if (test(path))
+            paths << path;
+    // file names that begin with it first, then the shorter paths
+    if (!folded.isEmpty()) {
+        const QByteArray &last = folded.constLast();
+        auto begins = [&](const QByteArray &path) {
+            QByteArray f = path.mid(path.lastIndexOf('/', path.size() - 2) + 1);
+            fold(f);
+            return f.startsWith(last);
+        };
+        std::stable_sort(paths.begin(), paths.end(), [&](const QByteArray &a, const QByteArray &b) {
+            const bool ba = begins(a), bb = begins(b);
+            return ba != bb ? ba : a.size() < b.size();
+        });
+    }
+    QStringList list;
+    for (int i = 0; i < paths.size() && i < max; ++i)
+        list << QFile::decodeName(paths.at(i));
+    return list;
+}
+
+void FileIndex::setRoots(const QStringList &roots) {
+    QStringList expanded;
+    for (QString root : roots) {
+        if (root.startsWith('~'))
+            root.replace(0, 1, QDir::homePath());
+        if (!root.isEmpty())
+            expanded << QDir::cleanPath(root);
+    }
+    if (expanded == m_roots)
+        return;
+    m_roots = expanded;
+    clear();
+    if (m_watcher && !m_watcher->directories().isEmpty())
+        m_watcher->removePaths(m_watcher->directories());
+    if (m_roots.isEmpty()) {
+        m_recrawl.stop();
+        return;
+    }
+    m_recrawl.start();
+    // outdated or not, that's better than nothing
+    if (!load(indexPath()) || QDateTime::currentMSecsSinceEpoch() - m_built > RECRAWL)
+        crawl();
+}
+
+void FileIndex::settle() {
+    if (m_search)
+        m_search->waitForFinished();
+}
@@ -0,0 +1,78 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef FILEINDEX_H
+#define FILEINDEX_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+class QFileSystemWatcher;
+
+// Memory mapped, sorted database of the paths below some roots, to look files up by name
+// The paths are front coded (shared prefix with the previous one + the rest), every
+// BLOCK_SIZE-th whole, so the lookups can be split over the cores and prefixes found by bisection.
+// The crawl runs in the background at idle priority once a day, in between the directories
+// that changed lately are watched and their changes kept on top of the database.
+// Lookups run off the GUI thread, only the latest one asked for while searching follows.
+class FileIndex : public QObject {
+    Q_OBJECT
+public:
+    FileIndex(QObject *parent = nullptr);
+    ~FileIndex();
+    int count() const { return m_count; }
+    void find(const QStringList &tokens, int max = 10000); // found() has the paths
+    bool isCrawling() const { return m_crawler && m_crawler->isRunning(); }
+    void setRoots(const QStringList &roots); // empty stops it
+signals:
+    void found(const QStringList &paths);
+    void updated();
+private:
+    struct Header;
+    static QByteArray build(const QStringList &roots, const QString &path);
+    void clear();
+    bool load(const QString &path);
+    bool load(const QByteArray &data);
+    bool map(const uchar *data, qint64 size);
+    void crawl();
+    QList<QByteArray> children(const QByteArray &dir) const; // in the database
+    void rescan(const QString &dir);
+    QStringList search(const QStringList &tokens, int max, const QSet<QByteArray> &added, const QSet<QByteArray> &removed) const;
+    void settle(); // no search may read the mapping that's about to go
+    QFile m_file;
+    QByteArray m_buffer;
+    const quint32 *m_blocks;
+    const uchar *m_data, *m_dataEnd;
+    int m_count, m_blockCount;
+    qint64 m_built; // ms since epoch
+    QStringList m_roots, m_hot;
+    QSet<QByteArray> m_added, m_removed; // on top of the database, from the watched dirs
+    QFileSystemWatcher *m_watcher;
+    QFutureWatcher<QByteArray> *m_crawler;
+    QFutureWatcher<QStringList> *m_search;
+    QStringList m_nextTokens; // asked for while searching
+    int m_nextMax;
+    QTimer m_recrawl;
+};
+
+#endif // FILEINDEX_H
@@ -0,0 +1,155 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+
+#include "frecency.h"
+
+#define FRECENCY_MAGIC 0x51495146 // QIQF
+#define FRECENCY_VERSION 1
+#define MAX_RANK 10000 // total, then everything gets aged
+
+Frecency::Frecency() : m_dirty(false) {
+}
+
+void Frecency::age() {
+    float total = 0;
+    for (const Entry &entry : std::as_const(m_entries))
+        total += entry.rank;
+    if (total <= MAX_RANK)
+        return;
+    const float factor = 0.9f*MAX_RANK/total;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        it->rank *= factor;
+        if (it->rank < 1)
+            it = m_entries.erase(it);
+        else
+            ++it;
+    }
+}
+
+bool Frecency::load(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_5);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    quint32 magic, version, count;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != FRECENCY_MAGIC || version != FRECENCY_VERSION)
+        return false;
+    QHash<QString, Entry> entries;
+    entries.reserve(count);
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QByteArray name; // local 8bit, half the size of a QString
+        Entry entry;
+        quint8 dir;
+        stream >> name >> entry.rank >> entry.atime >> dir;
+        entry.dir = dir;
+        entries.insert(QFile::decodeName(name), entry);
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+    m_entries = entries;
+    m_dirty = false;
+    return true;
+}
+
+QStringList Frecency::query(const QStringList &tokens, Kind kind, int max) {
+    const quint32 now = QDateTime::currentSecsSinceEpoch();
+    auto frecency = [=](const Entry &entry) {
+        const quint32 age = now - qMin(now, entry.atime);
+        if (age < 3600)
+            return entry.rank*4;
+        if (age < 86400)
+            return entry.rank*2;
+        if (age < 604800)
+            return entry.rank/2;
+        return entry.rank/4;
+    };
+    QList<QPair<float, QString>> hits;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        if (!(kind & (it->dir ? Dirs : Files)))
+            continue;
+        const QString &path = it.key();
+        int pos = 0;
+        bool match = true;
+        for (const QString &token : tokens) {
+            if ((pos = path.indexOf(token, pos, Qt::CaseInsensitive)) < 0) {
+                match = false;
+                break;
+            }
+            pos += token.size();
+        }
+        // "foo" should find ~/foo, not ~/foo/bar/baz
+        if (match && !tokens.isEmpty() && path.lastIndexOf(tokens.constLast(), -1, Qt::CaseInsensitive) < path.lastIndexOf('/'))
+            match = false;
+        if (match)
+            hits << qMakePair(frecency(*it), path);
+    }
+    std::sort(hits.begin(), hits.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    QStringList paths;
+    for (const auto &hit : std::as_const(hits)) {
+        if (!QFileInfo::exists(hit.second)) { // gone, forget about it
+            m_entries.remove(hit.second);
+            m_dirty = true;
+            continue;
+        }
+        paths << hit.second;
+        if (paths.size() == max)
+            break;
+    }
+    return paths;
+}
+
+bool Frecency::save(const QString &path) {
+    if (!m_dirty)
+        return true;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_5);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << quint32(FRECENCY_MAGIC) << quint32(FRECENCY_VERSION) << quint32(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+        stream << QFile::encodeName(it.key()) << it->rank << it->atime << quint8(it->dir);
+    if (!file.commit())
+        return false;
+    m_dirty = false;
+    return true;
+}
+
+void Frecency::visit(const QString &path, bool dir) {
+    if (path.isEmpty() || path == QDir::homePath() || path == "/")
+        return; // nothing to jump to
+    Entry &entry = m_entries[path];
+    entry.rank += 1;
+    entry.atime = QDateTime::currentSecsSinceEpoch();
+    entry.dir = dir;
+    m_dirty = true;
+    age();
+}
@@ -0,0 +1,49 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef FRECENCY_H
+#define FRECENCY_H
+
+#include <QHash>
+#include <QStringList>
+
+// Directories and files that were visited, ranked by how often and how recently
+// Every visit adds to the rank, once the ranks add up to too much they all shrink and
+// what's left below 1 is forgotten. Lookups weight the rank by the time since the last visit.
+class Frecency {
+public:
+    enum Kind { Dirs = 1, Files = 2, All = Dirs|Files };
+    Frecency();
+    bool isDirty() const { return m_dirty; }
+    bool load(const QString &path);
+    // paths that contain the tokens in order, the last one in the last path component, best first
+    QStringList query(const QStringList &tokens, Kind kind = All, int max = 32);
+    bool save(const QString &path);
+    void visit(const QString &path, bool dir);
+private:
+    struct Entry {
+        float rank = 0;
+        quint32 atime = 0; // seconds since epoch
+        bool dir = false;
+    };
+    void age();
+    QHash<QString, Entry> m_entries;
+    bool m_dirty;
+};
+
+#endif // FRECENCY_H
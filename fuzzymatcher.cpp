@@ -0,0 +1,161 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "fuzzymatcher.h"
+
+// the fzf weights
+enum {
+    ScoreMatch = 16,
+    ScoreGapStart = -3,
+    ScoreGapExtension = -1,
+    BonusBoundary = ScoreMatch / 2,
+    BonusNonWord = ScoreMatch / 2,
+    BonusCamel123 = BonusBoundary + ScoreGapExtension,
+    BonusConsecutive = -(ScoreGapStart + ScoreGapExtension),
+    BonusFirstCharMultiplier = 2
+};
+
+enum CharClass { NonWord = 0, Lower, Upper, Number };
+
+static inline char16_t fold(QChar c) {
+    const char16_t u = c.unicode();
+    if (u < 0x80)
+        return (u >= 'A' && u <= 'Z') ? u + 32 : u;
+    return c.toCaseFolded().unicode();
+}
+
+static inline quint64 charBit(char16_t c) {
+    if (c >= 'a' && c <= 'z')
+        return 1ull << (c - 'a');
+    if (c >= '0' && c <= '9')
+        return 1ull << (26 + c - '0');
+    if (c < 0x80)
+        return 1ull << (36 + c % 27);
+    return 1ull << 63; // everything else
+}
+
+static inline CharClass charClass(QChar c) {
+    if (c.isUpper())
+        return Upper;
+    if (c.isDigit())
+        return Number;
+    if (c.isLetter())
+        return Lower;
+    return NonWord;
+}
+
+static inline int bonus(CharClass prev, CharClass cls) {
+    if (prev == NonWord && cls != NonWord)
+        return BonusBoundary;
+    if ((prev == Lower && cls == Upper) || (prev != Number && cls == Number))
+        return BonusCamel123;
+    if (cls == NonWord)
+        return BonusNonWord;
+    return 0;
+}
+
+FuzzyMatcher::FuzzyMatcher(QStringView needle) : m_mask(0) {
+    m_needle.reserve(needle.size());
+    for (QChar c : needle) {
+        m_needle.append(QChar(fold(c)));
+        m_mask |= charBit(fold(c));
+    }
+}
+
+quint64 FuzzyMatcher::charMask(QStringView text) {
+    quint64 mask = 0;
+    for (QChar c : text)
+        mask |= charBit(fold(c));
+    return mask;
+}
+
+QList<int> FuzzyMatcher::prefilter(const QList<quint64> &masks, quint64 needed) {
+    QList<int> rows;
+    int i = 0;
+#if defined(__SSE2__)
+    // two masks per step, no 64bit compare in SSE2 but both 32bit halves matching will do
+    const __m128i need = _mm_set1_epi64x(needed);
+    for (; i + 1 < masks.size(); i += 2) {
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.constData() + i));
+        const int hits = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(m, need), need));
+        if ((hits & 0x00ff) == 0x00ff)
+            rows << i;
+        if ((hits & 0xff00) == 0xff00)
+            rows << i + 1;
+    }
+#endif
+    for (; i < masks.size(); ++i) {
+        if ((masks.at(i) & needed) == needed)
+            rows << i;
+    }
+    return rows;
+}
+
+int FuzzyMatcher::score(QStringView hay) const {
+    const int n = m_needle.size();
+    if (!n)
+        return 0;
+    // the first complete match ends the window, walking back from there finds its tightest start
+    int p = 0, end = -1;
+    for (int i = 0; i < hay.size(); ++i) {
+        if (fold(hay.at(i)) == m_needle.at(p).unicode() && ++p == n) {
+            end = i;
+            break;
+        }
+    }
+    if (end < 0)
+        return -1;
+    int start = end;
+    for (p = n - 1; start >= 0; --start) { // there is a match, so this stops at one
+        if (fold(hay.at(start)) == m_needle.at(p).unicode() && --p < 0)
+            break;
+    }
+    int score = 0, consecutive = 0, firstBonus = 0;
+    bool inGap = false;
+    CharClass prev = start > 0 ? charClass(hay.at(start - 1)) : NonWord;
+    p = 0;
+    for (int i = start; i <= end; ++i) {
+        const CharClass cls = charClass(hay.at(i));
+        if (p < n && fold(hay.at(i)) == m_needle.at(p).unicode()) {
+            int b = bonus(prev, cls);
+            if (consecutive == 0) {
+                firstBonus = b;
+            } else {
+                // a chunk keeps the bonus of its start
+                if (b >= BonusBoundary && b > firstBonus)
+                    firstBonus = b;
+                b = qMax(qMax(b, firstBonus), int(BonusConsecutive));
+            }
+            score += ScoreMatch + (p == 0 ? b * BonusFirstCharMultiplier : b);
+            inGap = false;
+            ++consecutive;
+            ++p;
+        } else {
+            score += inGap ? ScoreGapExtension : ScoreGapStart;
+            inGap = true;
+            consecutive = 0;
+            firstBonus = 0;
+        }
+        prev = cls;
+    }
+    return qMax(0, score);
+}
@@ -0,0 +1,41 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <QList>
+#include <QString>
+
+// fzf style subsequence matching, "ffx" finds "Firefox"
+// Scores the tightest match window with bonuses for word boundaries and consecutive
+// characters and penalties for gaps.
+// The character masks allow to reject most rows w/o looking at their text.
+class FuzzyMatcher {
+public:
+    FuzzyMatcher(QStringView needle);
+    quint64 mask() const { return m_mask; }
+    int score(QStringView hay) const; // -1 if the needle isn't a subsequence
+    static quint64 charMask(QStringView text);
+    static QList<int> prefilter(const QList<quint64> &masks, quint64 needed);
+private:
+    QString m_needle; // case folded
+    quint64 m_mask;
+};
+
+#endif // FUZZYMATCHER_H
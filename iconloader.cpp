@@ -0,0 +1,334 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QPixmap>
+#include <QSettings>
+#include <QSharedPointer>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <climits>
+
+#include "iconloader.h"
+
+// https://gitlab.gnome.org/GNOME/gtk/-/blob/main/docs/iconcache.txt
+class GtkIconCache {
+public:
+    GtkIconCache() : m_data(nullptr), m_size(0) {}
+    bool open(const QString &themeDir) {
+        m_file.setFileName(themeDir + "/icon-theme.cache");
+        QFileInfo info(m_file);
+        // gtk-update-icon-cache touches the cache after the directory, otherwise it's stale
+        if (!info.exists() || info.lastModified() < QFileInfo(themeDir).lastModified())
+            return false;
+        if (!m_file.open(QIODevice::ReadOnly))
+            return false;
+        m_size = m_file.size();
+        m_data = m_file.map(0, m_size);
+        if (!m_data || read16(0) != 1) {
+            m_data = nullptr;
+            return false;
+        }
+        return true;
+    }
+    bool isValid() const { return m_data; }
+    // the subdirectories that hold the icon and their suffix flags
+    QList<QPair<QString, int>> lookup(const QByteArray &name) const {
+        QList<QPair<QString, int>> hits;
+        const quint32 hashOffset = read32(4), dirListOffset = read32(8);
+        const quint32 buckets = read32(hashOffset);
+        if (!buckets)
+            return hits;
+        quint32 icon = read32(hashOffset + 4 + 4*(hash(name.constData()) % buckets));
+        while (icon != 0xffffffff && icon) {
+            const char *iconName = string(read32(icon + 4));
+            if (iconName && name == iconName) {
+                const quint32 images = read32(icon + 8);
+                const quint32 count = read32(images);
+                for (quint32 i = 0; i < count; ++i) {
+                    const quint16 dir = read16(images + 4 + 8*i);
+                    const quint16 flags = read16(images + 4 + 8*i + 2);
+                    if (const char *dirName = string(read32(dirListOffset + 4 + 4*dir)))
+                        hits << qMakePair(QString::fromUtf8(dirName), int(flags));
+                }
+                break;
+            }
+            icon = read32(icon);
+        }
+        return hits;
+    }
+    enum Suffix { XPM = 1, SVG = 2, PNG = 4 };
+private:
+    static quint32 hash(const char *p) {
+        quint32 h = static_cast<signed char>(*p);
+        if (h) {
+            for (p += 1; *p; ++p)
+                h = (h << 5) - h + static_cast<signed char>(*p);
+        }
+        return h;
+    }
+    // big endian and every offset is untrusted
+    quint16 read16(quint32 offset) const {
+        if (offset + 2 > m_size)
+            return 0;
+        return (m_data[offset] << 8) | m_data[offset+1];
+    }
+    quint32 read32(quint32 offset) const {
+        if (offset + 4 > m_size)
+            return 0xffffffff;
+        return (quint32(m_data[offset]) << 24) | (m_data[offset+1] << 16) | (m_data[offset+2] << 8) | m_data[offset+3];
+    }
+    const char *string(quint32 offset) const {
+        if (offset >= m_size)
+            return nullptr;
+        const char *s = reinterpret_cast<const char*>(m_data + offset);
+        return qstrnlen(s, m_size - offset) < m_size - offset ? s : nullptr;
+    }
+    QFile m_file;
+    const uchar *m_data;
+    qint64 m_size;
+};
+
+// The freedesktop icon theme lookup, reduced to what a list of application icons needs
+class IconThemes {
+public:
+    IconThemes(const QString &theme, const QStringList &searchPaths) : m_name(theme), m_searchPaths(searchPaths), m_stamp(0) {
+        QStringList pending = QStringList() << theme << "hicolor";
+        QSet<QString> seen;
+        while (!pending.isEmpty()) {
+            const QString name = pending.takeFirst();
+            if (name.isEmpty() || seen.contains(name))
+                continue;
+            seen.insert(name);
+            Theme t;
+            for (const QString &path : m_searchPaths) {
+                const QString base = path + "/" + name;
+                const QFileInfo index(base + "/index.theme");
+                if (!QFileInfo::exists(base))
+                    continue;
+                t.bases << base;
+                t.caches << QSharedPointer<GtkIconCache>(new GtkIconCache);
+                if (!t.caches.last()->open(base))
+                    t.caches.last().reset();
+                else
+                    m_stamp = qMax(m_stamp, QFileInfo(base + "/icon-theme.cache").lastModified().toSecsSinceEpoch());
+                if (!index.exists() || !t.dirs.isEmpty())
+                    continue;
+                m_stamp = qMax(m_stamp, index.lastModified().toSecsSinceEpoch());
+                QSettings reader(index.filePath(), QSettings::IniFormat);
+                const QStringList keys = reader.allKeys();
+                for (const QString &key : keys) {
+                    if (!key.endsWith("/Size"))
+                        continue;
+                    Dir d;
+                    d.path = key.chopped(5);
+                    d.size = reader.value(key).toInt();
+                    const QString type = reader.value(d.path + "/Type", "Threshold").toString();
+                    d.type = type == "Fixed" ? Dir::Fixed : type == "Scalable" ? Dir::Scalable : Dir::Threshold;
+                    d.minSize = reader.value(d.path + "/MinSize", d.size).toInt();
+                    d.maxSize = reader.value(d.path + "/MaxSize", d.size).toInt();
+                    d.threshold = reader.value(d.path + "/Threshold", 2).toInt();
+                    t.dirIndex.insert(d.path, t.dirs.size());
+                    t.dirs << d;
+                }
+                pending << reader.value("Icon Theme/Inherits").toStringList();
+            }
+            if (!t.bases.isEmpty())
+                m_themes << t;
+        }
+    }
+    const QString &name() const { return m_name; }
+    qint64 stamp() const { return m_stamp; }
+    QString lookup(const QString &icon, int size) const {
+        const QByteArray name = icon.toUtf8();
+        static const char *suffixes[3] = { ".png", ".svg", ".xpm" };
+        for (const Theme &theme : m_themes) {
+            QString best;
+            int bestDistance = INT_MAX;
+            auto consider = [&](const QString &base, int dir, const char *suffix) {
+                const int distance = theme.dirs.at(dir).distance(size);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = base + "/" + theme.dirs.at(dir).path + "/" + icon + suffix;
+                }
+            };
+            for (int b = 0; b < theme.bases.size() && bestDistance; ++b) {
+                const QString &base = theme.bases.at(b);
+                if (const GtkIconCache *cache = theme.caches.at(b).data()) {
+                    const QList<QPair<QString, int>> hits = cache->lookup(name);
+                    for (const QPair<QString, int> &hit : hits) {
+                        const int dir = theme.dirIndex.value(hit.first, -1);
+                        if (dir < 0)
+                            continue;
+                        if (hit.second & GtkIconCache::PNG)
+                            consider(base, dir, suffixes[0]);
+                        else if (hit.second & GtkIconCache::SVG)
+                            consider(base, dir, suffixes[1]);
+                        else if (hit.second & GtkIconCache::XPM)
+                            consider(base, dir, suffixes[2]);
+                    }
+                    continue;
+                }
+                // no usable cache, we've to walk the directories
+                for (int dir = 0; dir < theme.dirs.size() && bestDistance; ++dir) {
+                    for (const char *suffix : suffixes) {
+                        if (QFileInfo::exists(base + "/" + theme.dirs.at(dir).path + "/" + icon + suffix)) {
+                            consider(base, dir, suffix);
+                            break;
+                        }
+                    }
+                }
+            }
+            if (!best.isEmpty())
+                return best;
+        }
+        for (const char *suffix : suffixes) {
+            const QString pixmap = "/usr/share/pixmaps/" + icon + suffix;
+            if (QFileInfo::exists(pixmap))
+                return pixmap;
+        }
+        return QString();
+    }
+private:
+    struct Dir {
+        enum Type { Fixed, Scalable, Threshold };
+        int distance(int iconSize) const {
+            switch (type) {
+                case Fixed:
+                    return qAbs(size - iconSize);
+                case Scalable:
+                    if (iconSize < minSize)
+                        return minSize - iconSize;
+                    return iconSize > maxSize ? iconSize - maxSize : 0;
+                case Threshold:
+                default:
+                    if (iconSize < size - threshold)
+                        return size - threshold - iconSize;
+                    return iconSize > size + threshold ? iconSize - size - threshold : 0;
+            }
+        }
+        QString path;
+        int size, minSize, maxSize, threshold;
+        Type type;
+    };
+    struct Theme {
+        QStringList bases;
+        QList<QSharedPointer<GtkIconCache>> caches;
+        QList<Dir> dirs;
+        QHash<QString, int> dirIndex;
+    };
+    QString m_name;
+    QStringList m_searchPaths;
+    QList<Theme> m_themes;
+    qint64 m_stamp;
+};
+
+static QImage scaledImage(const QString &path, int size) {
+    QImageReader reader(path);
+    QSize sz = reader.size();
+    if (!sz.isValid())
+        sz = QSize(size, size);
+    if (sz.width() > size || sz.height() > size || reader.format() == "svg") {
+        sz.scale(size, size, Qt::KeepAspectRatio);
+        reader.setScaledSize(sz);
+    }
+    return reader.read();
+}
+
+IconLoader::IconLoader(QObject *parent) : QObject(parent), m_icons(256), m_themes(nullptr), m_size(0), m_generation(0) {
+    m_pool.setMaxThreadCount(1); // the themes are not shared and the disk is the bottleneck anyway
+    m_pool.setThreadPriority(QThread::LowPriority);
+    m_readyCollector.setInterval(16);
+    m_readyCollector.setSingleShot(true);
+    connect(&m_readyCollector, &QTimer::timeout, this, &IconLoader::iconsReady);
+}
+
+IconLoader::~IconLoader() {
+    m_pool.clear();
+    m_pool.waitForDone();
+    delete m_themes;
+}
+
+void IconLoader::setSize(int size) {
+    if (size == m_size && m_themeName == QIcon::themeName())
+        return;
+    m_size = size;
+    m_themeName = QIcon::themeName();
+    ++m_generation;
+    m_icons.clear();
+    m_pending.clear();
+    emit iconsReady(); // the old ones are gone, the views have to ask again
+}
+
+QIcon IconLoader::icon(const QString &name) {
+    if (name.isEmpty())
+        return QIcon();
+    if (const QIcon *icon = m_icons.object(name))
+        return *icon;
+    if (m_pending.contains(name))
+        return QIcon();
+    m_pending.insert(name);
+    const uint generation = m_generation;
+    const int size = m_size;
+    const QString themeName = m_themeName;
+    const QStringList searchPaths = QIcon::themeSearchPaths();
+    static const QString cacheBase = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/icons/";
+    m_pool.start([=]() {
+        if (QFileInfo(name).isAbsolute()) {
+            const QImage image = scaledImage(name, size);
+            QMetaObject::invokeMethod(this, [=]() { deliver(name, image, generation); }, Qt::QueuedConnection);
+            return;
+        }
+        if (!m_themes || m_themes->name() != themeName) {
+            delete m_themes;
+            m_themes = new IconThemes(themeName, searchPaths);
+        }
+        const QString cacheDir = cacheBase + themeName + "/" + QString::number(size) + "/";
+        const QFileInfo cached(cacheDir + name + ".png");
+        QImage image;
+        if (cached.exists() && cached.lastModified().toSecsSinceEpoch() >= m_themes->stamp())
+            image.load(cached.filePath(), "PNG");
+        if (image.isNull()) {
+            const QString path = m_themes->lookup(name, size);
+            if (!path.isEmpty())
+                image = scaledImage(path, size);
+            if (!image.isNull()) {
+                QDir().mkpath(cacheDir);
+                image.save(cached.filePath(), "PNG");
+            }
+        }
+        QMetaObject::invokeMethod(this, [=]() { deliver(name, image, generation); }, Qt::QueuedConnection);
+    });
+    return QIcon();
+}
+
+void IconLoader::deliver(const QString &name, const QImage &image, uint generation) {
+    if (generation != m_generation)
+        return; // resized or retheming in the meantime
+    m_pending.remove(name);
+    // missing icons are cached as null, so they're not looked up over and over
+    m_icons.insert(name, new QIcon(image.isNull() ? QIcon() : QIcon(QPixmap::fromImage(image))));
+    if (!m_readyCollector.isActive()) // not restarted, a steady stream of icons would never show
+        m_readyCollector.start();
+}
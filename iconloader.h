@@ -0,0 +1,55 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef ICONLOADER_H
+#define ICONLOADER_H
+
+#include <QCache>
+#include <QIcon>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+
+class IconThemes;
+
+// Resolves theme icons on a worker thread, using the icon-theme.cache files and
+// an on-disk cache of images pre-scaled to the requested size.
+// Only a bounded set of icons is kept in memory, the views ask for what they show.
+class IconLoader : public QObject {
+    Q_OBJECT
+public:
+    IconLoader(QObject *parent = nullptr);
+    ~IconLoader();
+    QIcon icon(const QString &name); // null until resolved
+    void setSize(int size); // also picks up a changed icon theme
+signals:
+    void iconsReady();
+private:
+    void deliver(const QString &name, const QImage &image, uint generation);
+    QCache<QString, QIcon> m_icons;
+    QSet<QString> m_pending;
+    QThreadPool m_pool;
+    QTimer m_readyCollector;
+    IconThemes *m_themes; // only ever touched by the worker
+    QString m_themeName;
+    int m_size;
+    uint m_generation;
+};
+
+#endif // ICONLOADER_H
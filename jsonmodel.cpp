@@ -0,0 +1,327 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "jsonmodel.h"
+#include "outputbuffer.h"
+
+#define SCAN_CHUNK (1<<16)
+#define FETCH_ROWS 256
+#define MAX_VALUE 1024 // bytes, longer values are cut
+#define SNIFF_LINES 64
+#define SNIFF_SLACK 8 // bytes, the parser may stop a bit before the end of a cut off literal
+
+struct JsonModel::Node {
+    ~Node() { qDeleteAll(children); }
+    qint64 start() const { return keyFrom < 0 ? from : keyFrom; }
+    qint64 keyFrom = -1, keyTo = -1; // object members
+    qint64 from = 0, to = 0; // the value
+    qint64 scanned = -1; // where looking for children goes on
+    Node *parent = nullptr;
+    QList<Node*> children;
+    int index = 0; // in the parent
+    int row = 0; // in the view, differs for filtered top level nodes
+    char kind = 0; // the first byte of the value, 0 for a document of several
+    bool complete = false;
+};
+
+static QString decodeString(const QByteArray &raw) {
+    const QJsonDocument doc = QJsonDocument::fromJson("[" + raw + "]");
+    if (doc.isArray())
+        return doc.array().at(0).toString();
+    return QString::fromUtf8(raw.mid(1)) + "…"; // cut off
+}
+
+JsonModel::JsonModel(QObject *parent) : QAbstractItemModel(parent), m_root(nullptr), m_filtered(false) {
+}
+
+JsonModel::~JsonModel() {
+    delete m_root;
+}
+
+bool JsonModel::canFetchMore(const QModelIndex &parent) const {
+    if (!parent.isValid())
+        return m_root && !m_filtered && !m_root->complete;
+    const Node *node = static_cast<const Node*>(parent.internalPointer());
+    return (node->kind == '{' || node->kind == '[') && !node->complete;
+}
+
+int JsonModel::columnCount(const QModelIndex &) const {
+    return 2;
+}
+
+QVariant JsonModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+    const Node *node = static_cast<const Node*>(index.internalPointer());
+    if (index.column() == 0) {
+        if (node->keyFrom < 0)
+            return node->index;
+        return decodeString(m_buffer->read(node->keyFrom, qMin(node->keyTo - node->keyFrom, qint64(MAX_VALUE))));
+    }
+    if (node->kind == '{' || node->kind == '[') {
+        const QString brackets = node->kind == '{' ? "{%1}" : "[%1]";
+        return brackets.arg(node->complete ? QString::number(node->children.size()) : "…");
+    }
+    const QByteArray raw = m_buffer->read(node->from, qMin(node->to - node->from, qint64(MAX_VALUE)));
+    if (node->kind == '"')
+        return decodeString(raw);
+    return QString::fromUtf8(raw);
+}
+
+void JsonModel::fetchMore(const QModelIndex &parent) {
+    Node *node = parent.isValid() ? static_cast<Node*>(parent.internalPointer()) : m_root;
+    if (!node)
+        return;
+    const QList<Node*> found = scan(node, FETCH_ROWS);
+    if (found.isEmpty())
+        return;
+    beginInsertRows(parent, node->children.size(), node->children.size() + found.size() - 1);
+    node->children += found;
+    if (node == m_root)
+        m_top += found;
+    endInsertRows();
+}
+
+bool JsonModel::hasChildren(const QModelIndex &parent) const {
+    if (!parent.isValid())
+        return m_root && (!m_top.isEmpty() || canFetchMore(parent));
+    if (parent.column() > 0)
+        return false;
+    const Node *node = static_cast<const Node*>(parent.internalPointer());
+    return (node->kind == '{' || node->kind == '[') && (!node->complete || !node->children.isEmpty());
+}
+
+QVariant JsonModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+    return section ? tr("Value") : tr("Key");
+}
+
+QModelIndex JsonModel::index(int row, int column, const QModelIndex &parent) const {
+    if (!m_root || column < 0 || column > 1 || parent.column() > 0)
+        return QModelIndex();
+    const QList<Node*> &nodes = parent.isValid() ? static_cast<Node*>(parent.internalPointer())->children : m_top;
+    if (row < 0 || row >= nodes.size())
+        return QModelIndex();
+    return createIndex(row, column, nodes.at(row));
+}
+
+QModelIndex JsonModel::parent(const QModelIndex &child) const {
+    if (!child.isValid())
+        return QModelIndex();
+    const Node *node = static_cast<const Node*>(child.internalPointer());
+    if (!node->parent || node->parent == m_root)
+        return QModelIndex();
+    return createIndex(node->parent->row, 0, node->parent);
+}
+
+int JsonModel::rowCount(const QModelIndex &parent) const {
+    if (parent.column() > 0)
+        return 0;
+    if (!parent.isValid())
+        return m_top.size();
+    return static_cast<const Node*>(parent.internalPointer())->children.size();
+}
+
+QList<JsonModel::Node*> JsonModel::scan(Node *node, int max) {
+    QList<Node*> found;
+    if (node->complete)
+        return found;
+    const bool object = node->kind == '{';
+    const qint64 end = node->kind ? node->to - 1 : node->to; // w/o the closing bracket
+    qint64 pos = node->scanned < 0 ? (node->kind ? node->from + 1 : node->from) : node->scanned;
+    qint64 tokenFrom = -1, keyFrom = -1, keyTo = -1;
+    int depth = 0;
+    char kind = 0;
+    bool inString = false, escaped = false, inScalar = false;
+    // keys and values at the top of the node, objects alternate between them
+    auto token = [&](qint64 to) {
+        if (object && keyFrom < 0) {
+            keyFrom = tokenFrom;
+            keyTo = to;
+            return;
+        }
+        Node *child = new Node;
+        child->keyFrom = keyFrom;
+        child->keyTo = keyTo;
+        child->from = tokenFrom;
+        child->to = to;
+        child->kind = kind;
+        child->parent = node;
+        child->index = child->row = node->children.size() + found.size();
+        found << child;
+        keyFrom = keyTo = -1;
+    };
+    while (pos < end && found.size() < max) {
+        const QByteArray chunk = m_buffer->read(pos, qMin(end - pos, qint64(SCAN_CHUNK)));
+        const char *d = chunk.constData();
+        qsizetype i = 0;
+        while (i < chunk.size()) {
+            const char c = d[i++];
+            if (inString) {
+                if (escaped)
+                    escaped = false;
+                else if (c == '\\')
+                    escaped = true;
+                else if (c == '"') {
+                    inString = false;
+                    if (!depth)
+                        token(pos + i);
+                }
+                if (!inString && !depth && found.size() >= max)
+                    break;
+                continue;
+            }
+            if (inScalar) {
+                if (!strchr(" \t\r\n,:]}", c))
+                    continue;
+                inScalar = false;
+                token(pos + i - 1);
+            }
+            switch (c) {
+                case '"':
+                    inString = true;
+                    if (!depth) {
+                        tokenFrom = pos + i - 1;
+                        kind = c;
+                    }
+                    break;
+                case '{': case '[':
+                    if (!depth++) {
+                        tokenFrom = pos + i - 1;
+                        kind = c;
+                    }
+                    break;
+                case '}': case ']':
+                    if (depth > 0 && !--depth)
+                        token(pos + i);
+                    break;
+                case ' ': case '\t': case '\r': case '\n': case ',': case ':':
+                    break;
+                default:
+                    if (!depth) {
+                        inScalar = true;
+                        tokenFrom = pos + i - 1;
+                        kind = c;
+                    }
+            }
+            if (!depth && !inScalar && found.size() >= max)
+                break;
+        }
+        pos += i;
+    }
+    if (pos >= end) {
+        if (inScalar)
+            token(end);
+        node->complete = true;
+    }
+    node->scanned = pos;
+    return found;
+}
+
+void JsonModel::setBuffer(QSharedPointer<OutputBuffer> buffer) {
+    beginResetModel();
+    delete m_root;
+    m_root = nullptr;
+    m_top.clear();
+    m_filtered = false;
+    m_buffer = buffer;
+    if (m_buffer) {
+        m_root = new Node;
+        m_root->to = m_buffer->size();
+        m_root->children = scan(m_root, 2);
+        // a single object or array is the tree, not a document with one entry
+        if (m_root->complete && m_root->children.size() == 1 &&
+            (m_root->children.first()->kind == '{' || m_root->children.first()->kind == '[')) {
+            Node *node = m_root->children.takeFirst();
+            delete m_root;
+            m_root = node;
+            m_root->parent = nullptr;
+            m_root->children = scan(m_root, FETCH_ROWS);
+        }
+        m_top = m_root->children;
+    }
+    endResetModel();
+}
+
+void JsonModel::setFilter(const QString &filter) {
+    if (!m_root)
+        return;
+    beginResetModel();
+    m_filtered = !filter.isEmpty();
+    if (m_filtered) {
+        while (!m_root->complete)
+            m_root->children += scan(m_root, INT_MAX);
+        m_top.clear();
+        const QList<Node*> &nodes = m_root->children;
+        const QByteArray pattern = filter.toUtf8();
+        m_buffer->search(pattern, filter != filter.toLower(), m_root->from, m_root->to, [&](qint64 hit) -> qint64 {
+            auto next = std::upper_bound(nodes.cbegin(), nodes.cend(), hit, [](qint64 offset, const Node *node) {
+                return offset < node->start();
+            });
+            if (next == nodes.cbegin())
+                return hit + 1;
+            Node *node = *(next - 1);
+            if (hit + pattern.size() > node->to)
+                return hit + 1; // between the entries
+            m_top << node;
+            return node->to;
+        });
+    } else {
+        m_top = m_root->children;
+    }
+    for (int i = 0; i < m_top.size(); ++i)
+        m_top.at(i)->row = i;
+    endResetModel();
+}
+
+bool JsonModel::sniff(const QByteArray &head, const QByteArray &tail, bool complete) {
+    const QByteArray first = head.trimmed().left(1), last = tail.trimmed().right(1);
+    if (first.isEmpty() || last.isEmpty() || head.contains("\e["))
+        return false;
+    if (!((first == "{" && last == "}") || (first == "[" && last == "]")))
+        return false;
+    QJsonParseError error;
+    QJsonDocument::fromJson(head, &error);
+    if (error.error == QJsonParseError::NoError)
+        return true;
+    // a cut off head only breaks where it ends
+    if (!complete && error.error != QJsonParseError::GarbageAtEnd && error.offset >= head.size() - SNIFF_SLACK)
+        return true;
+    if (error.error != QJsonParseError::GarbageAtEnd)
+        return false;
+    // JSON lines, every one has to be a document
+    QList<QByteArray> lines = head.trimmed().split('\n');
+    if (!complete)
+        lines.removeLast();
+    if (lines.size() > SNIFF_LINES)
+        lines.resize(SNIFF_LINES);
+    if (lines.size() < 2)
+        return false;
+    return std::all_of(lines.cbegin(), lines.cend(), [](const QByteArray &line) {
+        QJsonParseError error;
+        return !QJsonDocument::fromJson(line, &error).isNull() && error.error == QJsonParseError::NoError;
+    });
+}
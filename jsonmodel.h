@@ -0,0 +1,58 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef JSONMODEL_H
+#define JSONMODEL_H
+
+#include <QAbstractItemModel>
+#include <QList>
+#include <QSharedPointer>
+
+class OutputBuffer;
+
+// JSON (or JSON lines) output as a tree that's only parsed as far as it's shown.
+// Nodes are byte ranges into the OutputBuffer, the children of a container are looked for
+// when it's expanded (and only as many as the view asks for), values are decoded when painted.
+class JsonModel : public QAbstractItemModel {
+    Q_OBJECT
+public:
+    JsonModel(QObject *parent = nullptr);
+    ~JsonModel();
+    QSharedPointer<OutputBuffer> buffer() const { return m_buffer; }
+    bool canFetchMore(const QModelIndex &parent) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    void setBuffer(QSharedPointer<OutputBuffer> buffer);
+    void setFilter(const QString &filter); // top level entries that contain it
+    static bool sniff(const QByteArray &head, const QByteArray &tail, bool complete); // head has to parse
+private:
+    struct Node;
+    QList<Node*> scan(Node *node, int max);
+    QSharedPointer<OutputBuffer> m_buffer;
+    Node *m_root;
+    QList<Node*> m_top; // the shown children of m_root
+    bool m_filtered;
+};
+
+#endif // JSONMODEL_H
@@ -46,6 +46,7 @@ static void sighandler(int signum) {
             if (gs_qiq) {
                 gs_qiq->writeTodoList();
                 gs_qiq->writeHistory();
+                gs_qiq->writeFrecency();
             }
             break;
         default:
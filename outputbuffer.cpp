@@ -0,0 +1,135 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QByteArrayMatcher>
+#include <QDir>
+#include <QTemporaryFile>
+
+#include <QtDebug>
+
+#include "outputbuffer.h"
+
+#define SEARCH_CHUNK (1<<20)
+
+OutputBuffer::OutputBuffer(qint64 limit, Mode mode) : m_spill(nullptr), m_limit(qMax(qint64(1), limit))
+                                                    , m_head(0), m_spilled(0), m_total(0), m_mode(mode) {
+}
+
+OutputBuffer::~OutputBuffer() {
+    delete m_spill; // removes the file
+}
+
+void OutputBuffer::append(const QByteArray &data) {
+    if (data.isEmpty())
+        return;
+    m_total += data.size();
+    QByteArrayView rest(data);
+    if (m_mode == Tail) {
+        if (rest.size() >= m_limit) {
+            rest = rest.last(m_limit);
+            m_memory.clear();
+            m_head = 0;
+        }
+        const qint64 room = qMin(m_limit - m_memory.size(), rest.size());
+        if (room > 0) {
+            m_memory.append(rest.first(room));
+            rest = rest.sliced(room);
+        }
+        // full, overwrite the oldest bytes
+        while (!rest.isEmpty()) {
+            const qint64 n = qMin(rest.size(), m_memory.size() - m_head);
+            memcpy(m_memory.data() + m_head, rest.constData(), n);
+            m_head = (m_head + n) % m_memory.size();
+            rest = rest.sliced(n);
+        }
+        return;
+    }
+    if (m_total - data.size() > size())
+        return; // spilling failed before, a gap would scramble what follows, so it's lost as well
+    if (!m_spill) {
+        const qint64 room = qMin(m_limit - m_memory.size(), rest.size());
+        m_memory.append(rest.first(room));
+        rest = rest.sliced(room);
+        if (rest.isEmpty())
+            return;
+        m_spill = new QTemporaryFile(QDir::tempPath() + "/qiq-output-XXXXXX");
+        if (!m_spill->open()) {
+            qWarning() << "cannot spill output to" << m_spill->fileName() << m_spill->errorString();
+            delete m_spill;
+            m_spill = nullptr;
+            return;
+        }
+    }
+    m_spill->seek(m_spilled);
+    const qint64 written = m_spill->write(rest.constData(), rest.size());
+    if (written > 0)
+        m_spilled += written;
+    if (written < rest.size()) // disk full or so, dropped() tells
+        qWarning() << "cannot spill output to" << m_spill->fileName() << m_spill->errorString();
+}
+
+QByteArray OutputBuffer::read(qint64 offset, qint64 length) const {
+    offset = qBound(qint64(0), offset, size());
+    length = qBound(qint64(0), length, size() - offset);
+    if (!length)
+        return QByteArray();
+    if (m_mode == Tail) {
+        // the ring starts with the oldest byte at m_head
+        const qint64 start = (m_head + offset) % m_memory.size();
+        const qint64 first = qMin(length, m_memory.size() - start);
+        QByteArray data = m_memory.mid(start, first);
+        if (first < length)
+            data += m_memory.left(length - first);
+        return data;
+    }
+    QByteArray data = m_memory.mid(offset, length);
+    if (data.size() < length && m_spill) {
+        m_spill->flush();
+        m_spill->seek(qMax(qint64(0), offset - m_memory.size()));
+        data += m_spill->read(length - data.size());
+    }
+    return data;
+}
+
+void OutputBuffer::search(const QByteArray &pattern, bool sensitive, qint64 from, qint64 to, const std::function<qint64(qint64)> &found) const {
+    if (pattern.isEmpty())
+        return;
+    const QByteArrayMatcher matcher(sensitive ? pattern : pattern.toLower());
+    to = qMin(to, size());
+    qint64 pos = qMax(qint64(0), from);
+    while (pos < to) {
+        // overlap, so a match across the chunks isn't missed
+        QByteArray chunk = read(pos, qMin(to - pos, qint64(SEARCH_CHUNK) + pattern.size() - 1));
+        if (!sensitive)
+            chunk = std::move(chunk).toLower();
+        qint64 next = pos + SEARCH_CHUNK;
+        for (qsizetype at = matcher.indexIn(chunk); at > -1; at = matcher.indexIn(chunk, at)) {
+            if (pos + at >= next)
+                break; // in the overlap, the next chunk has it
+            const qint64 resume = found(pos + at);
+            if (resume < 0)
+                return;
+            if (resume >= next) {
+                next = resume;
+                break;
+            }
+            at = qMax(at + 1, qsizetype(resume - pos));
+        }
+        pos = next;
+    }
+}
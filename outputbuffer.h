@@ -0,0 +1,53 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <QByteArray>
+
+#include <functional>
+
+class QTemporaryFile;
+
+// What a process printed, with no more than the limit in memory.
+// Spill keeps it all and writes what exceeds the limit to a temporary file,
+// Tail is a ring that only keeps the last limit bytes.
+class OutputBuffer {
+public:
+    enum Mode { Spill = 0, Tail };
+    OutputBuffer(qint64 limit, Mode mode = Spill);
+    ~OutputBuffer();
+    void append(const QByteArray &data);
+    qint64 dropped() const { return m_total - size(); } // the front for Tail, the end if Spill couldn't write
+    bool isSpilled() const { return m_spill; }
+    Mode mode() const { return m_mode; }
+    QByteArray read(qint64 offset, qint64 length) const;
+    // calls found with every match in [from, to), it returns where to go on looking, -1 stops
+    void search(const QByteArray &pattern, bool sensitive, qint64 from, qint64 to, const std::function<qint64(qint64)> &found) const;
+    qint64 size() const { return m_memory.size() + m_spilled; }
+    qint64 total() const { return m_total; }
+private:
+    Q_DISABLE_COPY(OutputBuffer)
+    QByteArray m_memory;
+    QTemporaryFile *m_spill;
+    qint64 m_limit, m_head, m_spilled, m_total;
+    Mode m_mode;
+};
+
+#endif // OUTPUTBUFFER_H
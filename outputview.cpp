@@ -0,0 +1,295 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <QFontDatabase>
+#include <QLabel>
+#include <QPainter>
+#include <QScrollBar>
+
+#include <algorithm>
+#include <cstring>
+
+#include "ansiconverter.h"
+#include "outputbuffer.h"
+#include "outputview.h"
+
+#define INDEX_SLICE (4<<20) // bytes per event loop cycle
+#define SEARCH_CHUNK (1<<20)
+#define MAX_LINE 4096 // bytes, what's beyond isn't shown
+#define MARGIN 6
+#define STYLE_SPAN (1<<16) // bytes between the noted styles, at most
+
+OutputView::OutputView(QWidget *parent) : QAbstractScrollArea(parent), m_indexed(0), m_dropped(0), m_longest(0)
+                                        , m_match(-1), m_follow(false) {
+    setFrameShape(QFrame::NoFrame);
+    setFocusPolicy(Qt::NoFocus);
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_header = new QLabel(this);
+    m_header->setWordWrap(true);
+    m_header->setAlignment(Qt::AlignCenter);
+    m_header->hide();
+    m_lines << 0;
+    m_styles << Checkpoint{0, AnsiConverter::Style()};
+    m_indexer.setInterval(0);
+    connect(&m_indexer, &QTimer::timeout, this, &OutputView::index);
+}
+
+// like vim's smartcase, but the byte search only folds ASCII, so anything else is matched exactly
+static bool caseSensitive(const QString &needle) {
+    for (const QChar c : needle) {
+        if (c.unicode() > 0x7f || c.isUpper())
+            return true;
+    }
+    return false;
+}
+
+bool OutputView::find(const QString &needle, int direction) {
+    m_needle = needle;
+    if (needle.isEmpty() || !m_buffer) {
+        m_match = -1;
+        viewport()->update();
+        return false;
+    }
+    const bool sensitive = caseSensitive(needle);
+    QByteArray pattern = needle.toLocal8Bit();
+    if (!sensitive)
+        pattern = pattern.toLower();
+    QScrollBar *bar = verticalScrollBar();
+    qint64 match = -1;
+    if (direction < 0) {
+        match = search(pattern, sensitive, m_match < 0 ? m_lines.at(bar->value()) : m_match, true);
+        if (match < 0)
+            match = search(pattern, sensitive, m_indexed, true);
+    } else {
+        const qint64 from = m_match < 0 ? m_lines.at(bar->value()) : m_match + direction;
+        match = search(pattern, sensitive, from, false);
+        if (match < 0 && from > 0)
+            match = search(pattern, sensitive, 0, false);
+    }
+    m_match = match;
+    if (match > -1) {
+        const int l = lineAt(match);
+        if (l < bar->value() || l >= bar->value() + bar->pageStep())
+            bar->setValue(l - bar->pageStep()/2);
+        QList<QTextLayout::FormatRange> formats;
+        AnsiConverter ansi;
+        styleAt(l, ansi);
+        const QString text = line(l, formats, ansi);
+        const qsizetype column = text.indexOf(needle, 0, sensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+        if (column > -1) {
+            QScrollBar *hbar = horizontalScrollBar();
+            const int x = fontMetrics().horizontalAdvance(text.left(column));
+            const int w = fontMetrics().horizontalAdvance(needle);
+            if (x < hbar->value() || x + w + 2*MARGIN > hbar->value() + viewport()->width())
+                hbar->setValue(x - viewport()->width()/3);
+        }
+    }
+    viewport()->update();
+    return match > -1;
+}
+
+void OutputView::index() {
+    if (!m_buffer || m_indexed >= m_buffer->size()) {
+        m_indexer.stop();
+        return;
+    }
+    const QByteArray slice = m_buffer->read(m_indexed, INDEX_SLICE);
+    const char *d = slice.constData();
+    qsizetype from = 0, tracked = 0;
+    while (const char *nl = static_cast<const char*>(memchr(d + from, '\n', slice.size() - from))) {
+        const qsizetype pos = nl - d;
+        const qint64 length = m_indexed + pos - m_lines.last();
+        m_longest = qMax(m_longest, length);
+        m_lines.append(m_indexed + pos + 1);
+        from = pos + 1;
+        // also after overlong lines, so line() never has to read what it doesn't show
+        if (length > MAX_LINE || m_lines.last() - m_lines.at(m_styles.last().line) >= STYLE_SPAN) {
+            m_tracker.track(slice.mid(tracked, from - tracked));
+            tracked = from;
+            m_styles << Checkpoint{int(m_lines.size() - 1), m_tracker.style()};
+        }
+    }
+    m_tracker.track(slice.mid(tracked));
+    m_indexed += slice.size();
+    m_longest = qMax(m_longest, m_indexed - m_lines.last());
+    updateScrollBars();
+    if (m_follow)
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    viewport()->update();
+}
+
+void OutputView::layoutHeader() {
+    int h = 0;
+    if (!m_header->isHidden()) {
+        h = qMin(height()/3, m_header->heightForWidth(width()));
+        m_header->setGeometry(0, 0, width(), h);
+    }
+    setViewportMargins(0, h, 0, 0);
+}
+
+QString OutputView::line(int i, QList<QTextLayout::FormatRange> &formats, AnsiConverter &ansi) const {
+    const qint64 from = m_lines.at(i);
+    const qint64 to = i + 1 < m_lines.size() ? m_lines.at(i+1) - 1 : m_indexed;
+    const QString text = ansi.toText(m_buffer->read(from, qMin(to - from, qint64(MAX_LINE))), formats);
+    if (to - from > MAX_LINE && i + 1 < m_lines.size()) // the rest may change the colors, the next line has a checkpoint
+        styleAt(i + 1, ansi);
+    return text;
+}
+
+int OutputView::lineAt(qint64 offset) const {
+    return std::upper_bound(m_lines.cbegin(), m_lines.cend(), offset) - m_lines.cbegin() - 1;
+}
+
+int OutputView::lineCount() const {
+    // a trailing newline doesn't start another line
+    if (m_lines.size() > 1 && m_lines.last() == m_indexed)
+        return m_lines.size() - 1;
+    return m_lines.size();
+}
+
+void OutputView::paintEvent(QPaintEvent *) {
+    if (!m_buffer)
+        return;
+    QPainter p(viewport());
+    p.setPen(palette().color(QPalette::Text));
+    const int lh = fontMetrics().lineSpacing();
+    const int first = verticalScrollBar()->value();
+    const int last = qMin(lineCount(), first + viewport()->height()/lh + 1);
+    const int matchLine = m_match < 0 ? -1 : lineAt(m_match);
+    const Qt::CaseSensitivity cs = caseSensitive(m_needle) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    QColor current = palette().color(QPalette::Highlight);
+    current.setAlpha(64);
+    QTextCharFormat match;
+    match.setBackground(palette().color(QPalette::Highlight));
+    match.setForeground(palette().color(QPalette::HighlightedText));
+    QTextOption option;
+    option.setWrapMode(QTextOption::NoWrap);
+    AnsiConverter ansi;
+    styleAt(first, ansi);
+    int y = 0;
+    for (int i = first; i < last; ++i, y += lh) {
+        QList<QTextLayout::FormatRange> formats;
+        const QString text = line(i, formats, ansi);
+        if (i == matchLine)
+            p.fillRect(0, y, viewport()->width(), lh, current);
+        if (!m_needle.isEmpty()) {
+            for (qsizetype pos = text.indexOf(m_needle, 0, cs); pos > -1; pos = text.indexOf(m_needle, pos + m_needle.size(), cs))
+                formats.append({int(pos), int(m_needle.size()), match});
+        }
+        QTextLayout layout(text, font());
+        layout.setTextOption(option);
+        layout.setFormats(formats);
+        layout.beginLayout();
+        QTextLine tl = layout.createLine();
+        if (tl.isValid())
+            tl.setLineWidth(1e6);
+        layout.endLayout();
+        layout.draw(&p, QPointF(MARGIN - horizontalScrollBar()->value(), y));
+    }
+}
+
+void OutputView::refresh() {
+    if (!m_buffer)
+        return;
+    if (m_buffer->dropped() != m_dropped) { // the ring moved on, the offsets are off
+        m_dropped = m_buffer->dropped();
+        m_lines = {0};
+        m_styles = {Checkpoint{0, AnsiConverter::Style()}};
+        m_tracker = AnsiConverter();
+        m_indexed = m_longest = 0;
+        m_match = -1;
+    }
+    index(); // right away, the rest follows
+    if (m_indexed < m_buffer->size())
+        m_indexer.start();
+}
+
+void OutputView::resizeEvent(QResizeEvent *event) {
+    QAbstractScrollArea::resizeEvent(event);
+    layoutHeader();
+    updateScrollBars();
+}
+
+void OutputView::scrollContentsBy(int dx, int dy) {
+    m_follow = verticalScrollBar()->value() == verticalScrollBar()->maximum();
+    QAbstractScrollArea::scrollContentsBy(dx, dy);
+}
+
+qint64 OutputView::search(const QByteArray &pattern, bool sensitive, qint64 from, bool backwards) const {
+    const qint64 overlap = pattern.size() - 1;
+    if (backwards) {
+        for (qint64 end = from; end > 0; end -= SEARCH_CHUNK) {
+            const qint64 start = qMax(qint64(0), end - SEARCH_CHUNK);
+            QByteArray chunk = m_buffer->read(start, end - start + overlap);
+            if (!sensitive)
+                chunk = std::move(chunk).toLower();
+            const qsizetype hit = chunk.lastIndexOf(pattern, end - start - 1);
+            if (hit > -1)
+                return start + hit;
+        }
+        return -1;
+    }
+    qint64 match = -1;
+    m_buffer->search(pattern, sensitive, from, m_indexed, [&](qint64 hit) {
+        match = hit;
+        return -1;
+    });
+    return match;
+}
+
+void OutputView::setBuffer(QSharedPointer<OutputBuffer> buffer, const QString &header) {
+    m_indexer.stop();
+    m_buffer = buffer;
+    m_dropped = buffer ? buffer->dropped() : 0;
+    m_lines = {0};
+    m_styles = {Checkpoint{0, AnsiConverter::Style()}};
+    m_tracker = AnsiConverter();
+    m_indexed = m_longest = 0;
+    m_needle.clear();
+    m_match = -1;
+    m_header->setText(header);
+    m_header->setVisible(!header.isEmpty());
+    layoutHeader();
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    m_follow = buffer && buffer->mode() == OutputBuffer::Tail; // that's where the interesting part is
+    refresh();
+    viewport()->update();
+}
+
+void OutputView::styleAt(int i, AnsiConverter &ansi) const {
+    auto next = std::upper_bound(m_styles.cbegin(), m_styles.cend(), i, [](int line, const Checkpoint &checkpoint) {
+        return line < checkpoint.line;
+    });
+    const Checkpoint &checkpoint = *(next - 1);
+    ansi.setStyle(checkpoint.style);
+    // less than STYLE_SPAN, or the line would have its own checkpoint
+    ansi.track(m_buffer->read(m_lines.at(checkpoint.line), m_lines.at(i) - m_lines.at(checkpoint.line)));
+}
+
+void OutputView::updateScrollBars() {
+    const int lh = fontMetrics().lineSpacing();
+    const int visible = qMax(1, viewport()->height()/lh);
+    verticalScrollBar()->setRange(0, qMax(0, lineCount() - visible));
+    verticalScrollBar()->setPageStep(visible);
+    const int cw = fontMetrics().horizontalAdvance('M');
+    horizontalScrollBar()->setRange(0, qMax(0, int(qMin(m_longest, qint64(MAX_LINE)))*cw + 2*MARGIN - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(4*cw);
+}
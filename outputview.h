@@ -0,0 +1,76 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef OUTPUTVIEW_H
+#define OUTPUTVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QList>
+#include <QSharedPointer>
+#include <QTextLayout>
+#include <QTimer>
+
+#include "ansiconverter.h"
+
+class OutputBuffer;
+class QLabel;
+
+// Shows plain or ANSI colored output of any size, straight from the OutputBuffer.
+// Only the line offsets are kept (and indexed a slice at a time), only the visible lines
+// are read and laid out. Colors carry over line breaks, the indexing notes the style at a
+// line every 64 KiB and after every overlong one, so the style a line starts with is never
+// far to look up.
+class OutputView : public QAbstractScrollArea {
+    Q_OBJECT
+public:
+    OutputView(QWidget *parent = nullptr);
+    QSharedPointer<OutputBuffer> buffer() const { return m_buffer; }
+    // 0 looks from the current match on (incremental), 1 for the next, -1 for the previous one
+    bool find(const QString &needle, int direction = 0);
+    void refresh(); // the buffer grew
+    void setBuffer(QSharedPointer<OutputBuffer> buffer, const QString &header = QString());
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+private:
+    void index();
+    void layoutHeader();
+    QString line(int i, QList<QTextLayout::FormatRange> &formats, AnsiConverter &ansi) const;
+    int lineAt(qint64 offset) const;
+    int lineCount() const;
+    qint64 search(const QByteArray &pattern, bool sensitive, qint64 from, bool backwards) const;
+    void styleAt(int i, AnsiConverter &ansi) const; // as it is when line i starts
+    void updateScrollBars();
+    struct Checkpoint {
+        int line;
+        AnsiConverter::Style style;
+    };
+    QSharedPointer<OutputBuffer> m_buffer;
+    QList<qint64> m_lines; // where they start
+    QList<Checkpoint> m_styles;
+    AnsiConverter m_tracker; // for the indexing
+    qint64 m_indexed, m_dropped, m_longest;
+    QTimer m_indexer;
+    QLabel *m_header;
+    QString m_needle;
+    qint64 m_match;
+    bool m_follow; // stick to the end while it grows
+};
+
+#endif // OUTPUTVIEW_H
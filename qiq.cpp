@@ -20,14 +20,15 @@
 #include <QClipboard>
 #include <QDir>
 #include <QElapsedTimer>
-#include <QFileIconProvider>
-#include <QFileSystemModel>
 #include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QHeaderView>
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QListView>
 #include <QPainter>
 #include <QProcess>
+#include <QScrollBar>
 #include <QSet>
 #include <QSettings>
 #include <QStandardItemModel>
@@ -35,31 +36,92 @@
 #include <QStringListModel>
 #include <QStyledItemDelegate>
 #include <QTextBrowser>
+#include <QTextCursor>
 #include <QThread>
 #include <QTimer>
+#include <QTreeView>
 #include <QWindow>
+#include <QtConcurrent>
 #include <QtEnvironmentVariables>
 #include <QtDBus/QDBusConnection>
 
 #include <LayerShellQt/Shell>
 #include <LayerShellQt/Window>
 
+#include <numeric>
 #include <unistd.h>
 
 #include <QtDebug>
 
+#include "ansiconverter.h"
+#include "applications.h"
+#include "binregistry.h"
+#include "cmdcompleter.h"
+#include "csvmodel.h"
+#include "dirmodel.h"
+#include "filefinder.h"
+#include "fileindex.h"
+#include "frecency.h"
+#include "fuzzymatcher.h"
 #include "gauge.h"
+#include "jsonmodel.h"
 #include "notifications.h"
+#include "outputbuffer.h"
+#include "outputview.h"
 #include "qiq.h"
+#include "resultmodel.h"
+#include "searchtable.h"
+#include "trigramindex.h"
 
 static QRegularExpression whitespace("[;|[:space:]]+"); //[^\\\\]* &
 #define HIST_SIZE 1000
+#define TRIGRAM_ROWS 512 // shorter lists are just scanned
+#define BACKGROUND_ROWS 8192 // shorter scans don't block the input noticeably
+#define BROWSER_LIMIT (1<<18) // more output goes to the OutputView, setHtml() and the layout of it get slow
+#define SNIFF_SIZE (1<<16) // what json and csv detection look at
+
+// what the rows in m_results matched, if the next needle only extends it nothing else can match
+// model and root changes show all rows again, so must we forget
+static struct Matches {
+    const QAbstractItemModel *model = nullptr;
+    QPersistentModelIndex root;
+    QString needle;
+    int type = 0;
+    void clear() { model = nullptr; needle.clear(); }
+} previousMatches;
+
+// the texts of the longer plain lists, so they can be scanned on the thread pool,
+// and their trigrams - those are built there as well, until then it's scans only
+static struct Haystack {
+    const QAbstractItemModel *model = nullptr;
+    QPersistentModelIndex root;
+    QStringList texts;
+    TrigramIndex index;
+    bool indexed = false;
+    int generation = 0; // an index built for older texts is dropped
+    void clear() { model = nullptr; texts.clear(); index.clear(); indexed = false; ++generation; }
+} haystack;
 
 static bool isWayland() {
     static bool yesno = qApp->platformName() == "wayland";
     return yesno;
 }
 
+// for the stylesheet, QLineEdit[completing=true] and QLineEdit[finding=true]
+static void setStyleFlag(QWidget *input, const char *flag, bool on) {
+    input->setProperty(flag, on);
+    input->style()->unpolish(input);
+    input->style()->polish(input);
+}
+
+static QString binariesSnapshot() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "binaries.snapshot";
+}
+
+static QString frecencyPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "frecency";
+}
+
 Qiq::Qiq(bool argb) : QStackedWidget() {
     if (argb)
         setAttribute(Qt::WA_TranslucentBackground);
@@ -72,14 +134,42 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
     m_notifications = new Notifications(argb);
 
     m_bins = nullptr;
+    m_binaries = new BinRegistry;
+    m_cmdCompleter = new CmdCompleter(this);
+    connect(m_cmdCompleter, &CmdCompleter::pendingChanged, this, [=](bool pending) { setStyleFlag(m_input, "completing", pending); });
+    m_frecency = new Frecency;
+    m_frecency->load(frecencyPath());
+    m_frecencySaver.setInterval(60000);
+    m_frecencySaver.setSingleShot(true);
+    connect(&m_frecencySaver, &QTimer::timeout, this, &Qiq::writeFrecency);
     m_external = nullptr;
     m_cmdCompleted = nullptr;
+    m_found = nullptr;
+    m_applications = nullptr;
+    m_finder = nullptr;
+    m_fileIndex = new FileIndex(this);
+    connect(m_fileIndex, &FileIndex::found, this, [=](const QStringList &paths) {
+        if (paths.isEmpty()) {
+            message(tr("<h1 align=center>Nothing</h1>"));
+            return;
+        }
+        m_externCmd = "_qiq";
+        if (!m_external)
+            m_external = new QStandardItemModel(this);
+        m_external->clear();
+        for (const QString &path : paths)
+            m_external->appendRow(new QStandardItem(path));
+        setModel(m_external);
+        filter(QString(), Partial);
+        setCurrentWidget(m_list);
+    });
     m_historySaver = nullptr;
     m_todoSaver = nullptr;
     m_todoDirty = false;
     m_todoSaved = true;
     m_selectionIsSynthetic = false;
     m_askingQuestion = false;
+    m_fuzzy = false;
     m_currentHistoryIndex = HIST_SIZE + 1;
 
     m_inotify = new QFileSystemWatcher(this);
@@ -94,14 +184,28 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
 
     QTimer *binlistUpdater = new QTimer(this);
     binlistUpdater->setSingleShot(true);
-    connect(binlistUpdater, &QTimer::timeout, this, &Qiq::updateBinaries);
+    static QSet<QString> changedBinDirs;
+    connect(binlistUpdater, &QTimer::timeout, [=]() {
+        // only re-read what changed and merge that into the list
+        bool changed = false;
+        for (const QString &dir : std::as_const(changedBinDirs))
+            changed = m_binaries->rescan(dir) || changed;
+        changedBinDirs.clear();
+        if (changed && m_bins)
+            m_bins->setStringList(m_binaries->names());
+        m_cmdCompleter->clearCache(); // completers might be new, gone or updated
+        m_binaries->save(binariesSnapshot());
+    });
     m_inotify->addPaths(qEnvironmentVariable("PATH").split(':'));
     connect(m_inotify, &QFileSystemWatcher::directoryChanged, [=](const QString &path) {
-        if (qEnvironmentVariable("PATH").split(':').contains(path))
+        if (qEnvironmentVariable("PATH").split(':').contains(path)) {
+            changedBinDirs.insert(path);
             binlistUpdater->start(5000);
+        }
     });
 
     addWidget(m_list = new QListView);
+    m_list->setModel(m_results = new ResultModel(this));
     m_list->setFrameShape(QFrame::NoFrame);
     m_list->setUniformItemSizes(true);
 
@@ -123,16 +227,38 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
     });
 
     addWidget(m_disp = new QTextBrowser);
+    m_outputLimit = 16<<20;
+    m_outputTail = false;
+    m_structuredOutput = true;
     m_disp->setFrameShape(QFrame::NoFrame);
     m_disp->setFocusPolicy(Qt::NoFocus);
     m_disp->document()->setDefaultStyleSheet("a{text-decoration:none;} hr{border-color:#666;}");
 //    m_disp->setFocusPolicy(Qt::ClickFocus);
+    addWidget(m_view = new OutputView);
+    addWidget(m_tree = new QTreeView);
+    m_tree->setFrameShape(QFrame::NoFrame);
+    m_tree->setFocusPolicy(Qt::NoFocus);
+    m_tree->setUniformRowHeights(true); // or it asks every row for its size
+    m_tree->setAlternatingRowColors(true);
+    m_tree->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_tree->header()->setStretchLastSection(true);
+    m_json = new JsonModel(this);
+    m_csv = new CsvModel(this);
 
     m_pwd = new QLabel(this);
     m_pwd->setObjectName("PWD_LABEL");
 
     m_input = new QLineEdit(this);
+    connect(m_input, &QLineEdit::textEdited, m_cmdCompleter, &CmdCompleter::cancel); // it's for a different line now
     connect(this, &QStackedWidget::currentChanged, [=]() {
+        if (currentWidget() != m_list && m_finder)
+            m_finder->cancel();
+        if (currentWidget() != m_view)
+            m_view->setBuffer(QSharedPointer<OutputBuffer>()); // let go of the memory and the spill file
+        if (currentWidget() != m_tree) {
+            m_json->setBuffer(QSharedPointer<OutputBuffer>());
+            m_csv->setBuffer(QSharedPointer<OutputBuffer>());
+        }
         adjustGeometry();
         m_pwd->raise();
         m_input->raise();
@@ -220,7 +346,7 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
     m_input->setPalette(pal);
     m_input->installEventFilter(this);
 
-    m_applications = new QStandardItemModel;
+    m_applications = new AppModel(this);
     QTimer *applicationUpdater = new QTimer(this);
     applicationUpdater->setSingleShot(true);
     connect(applicationUpdater, &QTimer::timeout, this, &Qiq::makeApplicationModel);
@@ -231,9 +357,7 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
     });
 
     makeApplicationModel();
-    m_files = new QFileSystemModel(this);
-    m_files->setFilter(QDir::AllEntries|QDir::NoDotAndDotDot|QDir::AllDirs|QDir::Hidden|QDir::System);
-    m_files->setIconProvider(new QFileIconProvider);
+    m_files = new DirModel(this);
     m_cmdHistory = new QStringListModel(this);
 
     setUpdatesEnabled(false);
@@ -248,9 +372,9 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
         if (text.isEmpty()) {
             m_notifications->preview(text); // hide
             m_input->hide();
-            if (currentWidget() == m_list && (m_list->model() == m_external || m_list->model() == m_notifications->model()))
+            if (currentWidget() == m_list && (m_results->sourceModel() == m_external || m_results->sourceModel() == m_notifications->model()))
                 return;
-            if (currentWidget() != m_disp)
+            if (currentWidget() != m_disp && currentWidget() != m_view && currentWidget() != m_tree)
                 setCurrentWidget(m_status);
             return;
         }
@@ -259,6 +383,7 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
             if (m_input->cursorPosition() > previousPos) { // otherwise the user cannot backspace out of the completion
                 static const QString qiq_reconfigure("qiq reconfigure");
                 static const QString qiq_countdown("qiq countdown [<msg>] <t>");
+                static const QString qiq_find("qiq find <name>");
                 m_input->blockSignals(true);
                 if (qiq_reconfigure.startsWith(text)) {
                     int pos = m_input->cursorPosition();
@@ -269,6 +394,10 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
                     m_input->setText(qiq_countdown);
                     m_input->setSelection(14, qiq_countdown.size()-14);
                     text = qiq_countdown;
+                } else if (qiq_find.startsWith(text)) {
+                    m_input->setText(qiq_find);
+                    m_input->setSelection(9, qiq_find.size()-9);
+                    text = qiq_find;
                 }
                 m_input->blockSignals(false);
                 previousPos = m_input->selectionStart();
@@ -305,6 +434,17 @@ Qiq::Qiq(bool argb) : QStackedWidget() {
     m_list->setFocusProxy(m_input);
     m_list->viewport()->setFocusProxy(m_input);
     m_disp->setFocusProxy(m_input);
+    m_view->setFocusProxy(m_input);
+    m_tree->setFocusProxy(m_input);
+    m_tree->viewport()->setFocusProxy(m_input);
+    connect(m_input, &QLineEdit::textChanged, [=](const QString &text) {
+        if (currentWidget() != m_tree)
+            return;
+        if (m_tree->model() == m_json)
+            m_json->setFilter(text);
+        else
+            m_csv->setFilter(text);
+    });
     m_status->setFocusProxy(m_input);
     setFocusProxy(m_input);
     m_autoHide.setInterval(3000);
@@ -469,17 +609,19 @@ void Qiq::updateTodoTimers() {
 }
 
 void Qiq::updateBinaries() {
-    const QStringList paths = qEnvironmentVariable("PATH").split(':');
-    QStringList binaries;
-    for (const QString &s : paths)
-        binaries.append(QDir(s).entryList(QDir::Files|QDir::Executable));
-    binaries.append(m_aliases.keys());
-    binaries.removeDuplicates();
-    binaries.sort();
+    static bool loaded = false;
+    if (!loaded) {
+        // the listings of the last run, only dirs with a different mtime get read
+        m_binaries->load(binariesSnapshot());
+        loaded = true;
+    }
+    m_binaries->scan(qEnvironmentVariable("PATH").split(':'), m_aliases.keys());
     if (!m_bins)
-        m_bins = new QStringListModel(binaries);
+        m_bins = new QStringListModel(m_binaries->names());
     else
-        m_bins->setStringList(binaries);
+        m_bins->setStringList(m_binaries->names());
+    m_binaries->save(binariesSnapshot());
+    m_cmdCompleter->clearCache();
 }
 
 void Qiq::setOffset(QPoint offset) {
@@ -515,11 +657,17 @@ void Qiq::reconfigure() {
     }
     sheet.close();
 
-    m_aha = settings.value("AHA").toString();
+    AnsiConverter::setColors(settings.value("AnsiColors", QStandardPaths::locate(QStandardPaths::AppDataLocation, "ansifilter.map")).toString());
     m_qalc = settings.value("CALC").toString();
     m_term = settings.value("TERMINAL", qEnvironmentVariable("TERMINAL")).toString();
-    m_cmdCompletion = settings.value("CmdCompleter").toString();
+    m_cmdCompleter->setCommand(settings.value("CmdCompleter").toString(), settings.value("CmdCompleterPersistent", false).toBool());
+    m_fileIndex->setRoots(settings.value("FileIndex").toStringList());
     m_cmdCompletionSep = settings.value("CmdCompletionSep").toString();
+    m_outputLimit = qMax(1, settings.value("OutputLimit", 16).toInt()) * qint64(1<<20);
+    m_outputTail = settings.value("OutputOverflow", "Spill").toString().compare("Tail", Qt::CaseInsensitive) == 0;
+    m_structuredOutput = settings.value("StructuredOutput", true).toBool();
+    m_fuzzy = settings.value("FuzzyMatching", false).toBool();
+    previousMatches.clear();
     m_previewCmds = settings.value("PreviewCommands").toStringList();
     m_historyPath = settings.value("HistoryPath").toString();
     if (!m_historyPath.isEmpty() && !m_historySaver) {
@@ -560,6 +708,8 @@ void Qiq::reconfigure() {
         resize(m_defaultSize);
     m_iconSize = settings.value("IconSize", 48).toUInt();
     m_list->setIconSize(QSize(m_iconSize,m_iconSize));
+    if (m_applications) // not yet on startup
+        m_applications->setIconSize(m_iconSize);
     QList<Gauge*> oldGauges = m_status->findChildren<Gauge*>();
     static QHash<QString,uint> gaugeNotificationIDs;
     for (const QString &gauge : gauges) {
@@ -643,114 +793,48 @@ void Qiq::reconfigure() {
 }
 
 void Qiq::makeApplicationModel() {
-    const QString de_DE = QLocale::system().name();
-    const QString de = de_DE.split('_').first();
-    const QString name_de_DE = "Name[" + de_DE + "]";
-    const QString name_de = "Name[" + de + "]";
-    const QString comment_de_DE = "Comment[" + de_DE + "]";
-    const QString comment_de = "Comment[" + de + "]";
-    const QString keywords_de_DE = "Keywords[" + de_DE + "]";
-    const QString keywords_de = "Keywords[" + de + "]";
-    m_applications->clear();
-    static QString cachePath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "apps." + de_DE + ".cache";
+    static QFutureWatcher<QByteArray> *indexer = nullptr;
+    const QString locale = QLocale::system().name();
+    static QString indexPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "apps." + locale + ".index";
+    m_applications->setIconSize(m_iconSize);
+    if (indexer && indexer->isRunning()) {
+        // package managers drop files in bursts, catch up once the current run is done
+        connect(indexer, &QFutureWatcher<QByteArray>::finished, this, &Qiq::makeApplicationModel,
+                Qt::ConnectionType(Qt::SingleShotConnection|Qt::UniqueConnection));
+        return;
+    }
+    QSharedPointer<const AppIndex> current = m_applications->appIndex();
+    if (!current) {
+        QSharedPointer<AppIndex> index(new AppIndex);
+        if (index->load(indexPath)) { // outdated or not, that's better than nothing
+            m_applications->setIndex(index);
+            current = index;
+        }
+    }
     const QStringList paths = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
-    QFileInfo cacheInfo(cachePath);
-    bool useCache = false;
-    if (cacheInfo.exists()) {
-        useCache = true;
+    QFileInfo indexInfo(indexPath);
+    if (current && indexInfo.exists()) {
+        bool upToDate = true;
         for (const QString &path : paths) {
-            if (QFileInfo(path).lastModified() > cacheInfo.lastModified()) {
-                useCache = false;
+            if (QFileInfo(path).lastModified() > indexInfo.lastModified()) {
+                upToDate = false;
                 break;
             }
         }
+        if (upToDate)
+            return;
     }
-    QSettings cache(cachePath, QSettings::IniFormat);
-    QPixmap dummyPix(m_iconSize,m_iconSize);
-    dummyPix.fill(Qt::transparent);
-    QIcon dummyIcon(dummyPix);
-    if (useCache) {
-        for (const QString &entry : cache.childGroups()) {
-            cache.beginGroup(entry);
-            QStandardItem *item = new QStandardItem(QIcon::fromTheme(cache.value("Icon").toString(), dummyIcon), cache.value("Name").toString());
-            item->setData(cache.value("Exec").toString(), AppExec);
-            item->setData(cache.value("Comment").toString(), AppComment);
-            item->setData(cache.value("Path"), AppPath);
-            item->setData(cache.value("Terminal", false).toBool(), AppNeedsTE);
-            item->setData(cache.value("Categories").toString().split(';'), AppCategories);
-            item->setData(cache.value("Keywords").toString().split(';'), AppKeywords);
-            m_applications->appendRow(item);
-            cache.endGroup();
-        }
-        return;
-    }
-    cache.clear();
-    QSet<QString> augmented;
-    for (const QString &path : paths) {
-        QDir dir(path);
-        if (!dir.exists())
-            continue;
-        const QStringList files = dir.entryList(QStringList() << "*.desktop", QDir::Files|QDir::Readable);
-        for (const QString &file : files) {
-            if (augmented.contains(file))
-                continue;
-            augmented.insert(file);
-            QSettings service(path + QDir::separator() + file, QSettings::IniFormat);
-            service.beginGroup("Desktop Entry");
-            if (service.value("Type").toString() != "Application")
-                continue;
-#define LOCAL_AWARE(_V_, _D_) QString _V_ = service.value(_V_##_de_DE).toString(); \
-                              if (_V_.isEmpty()) _V_ = service.value(_V_##_de).toString(); \
-                              if (_V_.isEmpty()) _V_ = service.value(_D_).toString();
-            LOCAL_AWARE(name, "Name")
-            if (name.isEmpty())
-                continue;
-            // only type and name are mandatory, but if there's no executable, this isn't any useful
-            const QString exec = service.value("Exec").toString();
-            if (exec.isEmpty())
-                continue;
-            cache.beginGroup(file);
-            cache.setValue("Name", name);
-            cache.setValue("Exec", exec);
-            QString icon = service.value("Icon").toString();
-            if (!icon.isEmpty())
-                cache.setValue("Icon", icon);
-            QStandardItem *item = new QStandardItem(QIcon::fromTheme(icon, dummyIcon), name);
-            item->setData(exec, AppExec);
-            //-----
-            LOCAL_AWARE(comment, "Comment")
-            if (!comment.isEmpty())
-                cache.setValue("Comment", comment);
-            item->setData(comment, AppComment);
-            //-----
-            QVariant v = service.value("Path");
-            if (v.isValid()) {
-                cache.setValue("Path", v);
-                item->setData(v, AppPath);
-            }
-            //-----
-            v = service.value("Terminal");
-            bool terminal = false;
-            if (v.isValid()) {
-                terminal = v.toBool();
-                cache.setValue("Terminal", terminal);
-            }
-            item->setData(terminal, AppNeedsTE);
-            //-----
-            QString cats = service.value("Categories").toString();
-            if (!cats.isEmpty())
-                cache.setValue("Categories", cats);
-            item->setData(cats.split(';'), AppCategories);
-            //-----
-            LOCAL_AWARE(keywords, "Keywords")
-            if (!keywords.isEmpty())
-                cache.setValue("Keywords", keywords);
-            item->setData(keywords.split(';'), AppKeywords);
-            ///@todo mimetype ??
-            cache.endGroup();
-            m_applications->appendRow(item);
-        }
+    if (!indexer) {
+        indexer = new QFutureWatcher<QByteArray>(this);
+        connect(indexer, &QFutureWatcher<QByteArray>::finished, this, [=]() {
+            QSharedPointer<AppIndex> index(new AppIndex);
+            // prefer the mapping, the serialized data is the fallback for an unwritable index
+            if (index->load(indexPath) || index->load(indexer->result()))
+                m_applications->setIndex(index);
+        });
     }
+    // only the changed, added or removed desktop files are parsed, off the GUI thread
+    indexer->setFuture(QtConcurrent::run(&AppIndex::update, current, paths, indexPath, locale));
 }
 
 uint Qiq::notifyUser(const QString &summary, const QString &body, int urgency, uint id) {
@@ -781,7 +865,13 @@ void Qiq::adjustGeometry(bool now) {
         m_disp->setMinimumSize(QSize(0,0));
         setMinimumSize(QSize(0,0));
     }
-    if (currentWidget() == m_disp) {
+    if (currentWidget() == m_view || currentWidget() == m_tree) {
+        QSize max(800,800);
+        if (const QScreen *screen = windowHandle()->screen()) {
+            max = screen->geometry().size()*0.666666667;
+        }
+        resize(max.expandedTo(m_defaultSize)); // figuring the ideal size means laying it all out
+    } else if (currentWidget() == m_disp) {
         QSize max(800,800);
         if (const QScreen *screen = windowHandle()->screen()) {
             max = screen->geometry().size()*0.666666667;
@@ -796,7 +886,7 @@ void Qiq::adjustGeometry(bool now) {
     } else {
         QSize sz = m_defaultSize;
         if (currentWidget() == m_list) {
-            QRect r = m_list->visualRect(m_list->model()->index(m_lastVisibleRow, 0, m_list->rootIndex()));
+            QRect r = m_list->visualRect(m_results->index(m_lastVisibleRow, 0));
             sz.setHeight(qMax(qMin(r.bottom()+r.height(), sz.height()), 3*m_input->height()));
         }
         resize(sz);
@@ -855,7 +945,12 @@ class CmdComplDelegate : public QStyledItemDelegate {
 void Qiq::setModel(QAbstractItemModel *model) {
     static QFont monospace("monospace");
     static QAbstractItemDelegate *mainDelegate = nullptr;
-    m_list->setModel(model);
+    if (m_results->sourceModel() != model)
+        previousMatches.clear();
+    if (model != m_found && m_finder)
+        m_finder->cancel(); // nobody's looking anymore
+    m_results->setSourceModel(model);
+    gatherHaystack(); // so the trigrams are there for the first keystroke
     if (model == m_applications)
         m_list->setIconSize(QSize(m_iconSize,m_iconSize));
     else
@@ -882,7 +977,14 @@ void Qiq::setModel(QAbstractItemModel *model) {
 }
 
 void Qiq::setPwd(QString path) {
+    const bool changed = path != QDir::currentPath();
+    if (changed)
+        m_cmdCompleter->clearCache(); // the file completions at least
     QDir::setCurrent(path);
+    if (changed) {
+        m_frecency->visit(QDir::currentPath(), true);
+        m_frecencySaver.start();
+    }
     path.replace(QDir::homePath(), "~");
     m_pwd->setText(m_pwd->fontMetrics().elidedText(path, Qt::ElideLeft, width()/4-32));
     m_pwd->setToolTip(path == m_pwd->text() ? QString() : path);
@@ -898,6 +1000,9 @@ bool Qiq::event(QEvent *event) {
         if (m_grabKeyboard)
             grabKeyboard();
         QProcess::startDetached(wmscript, QStringList() << "show");
+    } else if (event->type() == QEvent::ThemeChange) {
+        if (m_applications)
+            m_applications->setIconSize(m_iconSize); // maybe another icon theme
     } else if (event->type() == QEvent::Hide) {
         if (m_grabKeyboard)
             releaseKeyboard();
@@ -938,7 +1043,7 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
         const int key = static_cast<QKeyEvent*>(e)->key();
         auto unselect = [=]() {
             int newPos = m_input->selectionEnd();
-            if (m_list->model() == m_files && m_input->text().at(newPos-1) == '"')
+            if ((m_results->sourceModel() == m_files || m_results->sourceModel() == m_found) && m_input->text().at(newPos-1) == '"')
                 --newPos;
             m_input->deselect();
             m_selectionIsSynthetic = false;
@@ -951,17 +1056,17 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
                     filter(QString(), Partial);
                     setCurrentWidget(m_list);
                 } else if (currentWidget() == m_list) {
-                    if (m_list->model() == m_applications) {
+                    if (m_results->sourceModel() == m_applications) {
                         setModel(m_bins);
                         filter(QString(), Begin);
-                    } else if (m_list->model() == m_bins) {
+                    } else if (m_results->sourceModel() == m_bins) {
                         setModel(m_external);
                         filter(QString(), Partial);
-                    } else if (m_list->model() == m_external) {
+                    } else if (m_results->sourceModel() == m_external) {
                         setModel(m_applications);
                         setCurrentWidget(m_disp);
                     }
-                } else if (currentWidget() == m_disp) {
+                } else if (currentWidget() == m_disp || currentWidget() == m_view || currentWidget() == m_tree) {
                     setCurrentWidget(m_status);
                 }
             } else if (m_selectionIsSynthetic && m_input->selectionEnd() > -1) {
@@ -971,6 +1076,10 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
             }
             return true;
         }
+        if ((key == Qt::Key_PageUp || key == Qt::Key_PageDown || key == Qt::Key_Up || key == Qt::Key_Down) && currentWidget() == m_tree) {
+            QApplication::sendEvent(m_tree, e);
+            return true;
+        }
         if ((key == Qt::Key_PageUp || key == Qt::Key_PageDown) && currentWidget() == m_list) {
             m_list->setEnabled(true);
             QApplication::sendEvent(currentWidget(), e);
@@ -1015,21 +1124,21 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
                 m_input->clear();
                 m_input->hide(); // force
                 m_input->setEchoMode(QLineEdit::Normal);
-            } else if (currentWidget() == m_list && m_list->model() == m_cmdHistory) {
+            } else if (currentWidget() == m_list && m_results->sourceModel() == m_cmdHistory) {
                 m_list->setCurrentIndex(QModelIndex());
                 runInput();
                 m_input->setText(m_inputBuffer);
             } else if (m_input->isVisible()) {
                 m_input->clear();
                 m_input->hide(); // force
-            } else if (currentWidget() == m_disp) {
+            } else if (currentWidget() == m_disp || currentWidget() == m_view || currentWidget() == m_tree) {
                 setCurrentWidget(m_status);
-            } else if (currentWidget() == m_list && m_list->model() == m_external) {
+            } else if (currentWidget() == m_list && m_results->sourceModel() == m_external) {
                 m_externalReply = QString(""); // empt, not null!
                 if (!m_wasVisble)
                     hide();
                 setCurrentWidget(m_status);
-            } else if (currentWidget() == m_list && m_list->model() == m_notifications->model()) {
+            } else if (currentWidget() == m_list && m_results->sourceModel() == m_notifications->model()) {
                 setCurrentWidget(m_status);
             } else if (currentWidget() == m_todo) {
                 /// @todo parse and save todo
@@ -1040,7 +1149,7 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
             }
             return true;
         }
-        if (key == Qt::Key_Space || (m_list->model() == m_files && static_cast<QKeyEvent*>(e)->text() == "/")) {
+        if (key == Qt::Key_Space || (m_results->sourceModel() == m_files && static_cast<QKeyEvent*>(e)->text() == "/")) {
             if (m_selectionIsSynthetic && m_input->selectionEnd() > -1) {
                 int newPos = m_input->selectionEnd();
                 if (key != Qt::Key_Space && m_input->text().at(newPos-1) == '"') // key != Qt::Key_Space implies "/" on files
@@ -1059,7 +1168,10 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
             return true;
         }
         if (key == Qt::Key_F && (static_cast<QKeyEvent*>(e)->modifiers() & Qt::ControlModifier)) {
-            completeDir(QDir::current(), true);
+            if (currentWidget() == m_list && m_results->sourceModel() == m_files && m_files->rootPath() == QDir::currentPath())
+                findFiles(); // again, everything below
+            else
+                completeDir(QDir::current(), true);
             return true;
         }
         if (key == Qt::Key_R && (static_cast<QKeyEvent*>(e)->modifiers() & Qt::ControlModifier)) {
@@ -1077,6 +1189,12 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
             setCurrentWidget(m_list);
             return true;
         }
+        if (key == Qt::Key_P && (static_cast<QKeyEvent*>(e)->modifiers() & Qt::ControlModifier) && currentWidget() == m_tree) {
+            // not a table after all, show it as text
+            m_view->setBuffer(m_tree->model() == m_json ? m_json->buffer() : m_csv->buffer());
+            setCurrentWidget(m_view);
+            return true;
+        }
         if (key == Qt::Key_T && (static_cast<QKeyEvent*>(e)->modifiers() & Qt::ControlModifier)) {
             m_input->clear();
             setCurrentWidget(m_todo);
@@ -1088,10 +1206,10 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
             !m_input->selectionLength() && m_input->cursorPosition() == m_input->text().size() &&
             // … and valid indices
             m_list->currentIndex().isValid()) {
-            if (m_list->model() == m_cmdHistory) {
+            if (m_results->sourceModel() == m_cmdHistory) {
                 m_history.removeAll(m_list->currentIndex().data().toString());
-                m_cmdHistory->removeRows(m_list->currentIndex().row(), 1);
-            } else if (m_list->model() == m_notifications->model()) {
+                m_cmdHistory->removeRows(m_results->mapToSource(m_list->currentIndex()).row(), 1);
+            } else if (m_results->sourceModel() == m_notifications->model()) {
                 m_notifications->purge(m_list->currentIndex().data(Notifications::ID).toUInt());
             }
         }
@@ -1116,45 +1234,109 @@ bool Qiq::eventFilter(QObject *o, QEvent *e) {
                 // fall through, input still needs to be handled
             }
         }
+        if (currentWidget() == m_view) {
+            if (key == Qt::Key_PageUp || key == Qt::Key_PageDown) {
+                if (m_input->text().isEmpty())
+                    m_view->verticalScrollBar()->triggerAction(key == Qt::Key_PageUp ? QAbstractSlider::SliderPageStepSub : QAbstractSlider::SliderPageStepAdd);
+                else
+                    m_view->find(m_input->text(), key == Qt::Key_PageUp ? -1 : 1);
+                return true;
+            }
+            if (!static_cast<QKeyEvent*>(e)->text().isEmpty()) // text needs to be updated first
+                QTimer::singleShot(0, [=](){ m_view->find(m_input->text()); });
+        }
         return false;
     }
     return false;
 }
 
 static bool cycleResults = false;
+
+// -1 if a token is missing, otherwise how well the whole needle fits
+static int partialScore(const QString &hay, const QStringList &tokens, const QString &needle, bool rank) {
+    for (const QString &token : tokens) {
+        if (!hay.contains(token, Qt::CaseInsensitive))
+            return -1;
+    }
+    if (!rank)
+        return 0;
+    if (hay.startsWith(needle))
+        return 100;
+    if (hay.contains(needle))
+        return 50;
+    return 1;
+}
+
+static int fuzzyScore(const QString &hay, const QList<FuzzyMatcher> &tokens) {
+    int score = 0;
+    for (const FuzzyMatcher &token : tokens) {
+        const int s = token.score(hay);
+        if (s < 0)
+            return -1;
+        score += s;
+    }
+    return score;
+}
+
+struct FilterChunk {
+    QList<int> rows, scores;
+};
 void Qiq::completeDir(const QDir &cdir, bool force, const QString ffilter) {
     setCurrentWidget(m_list);
     setModel(m_files);
-    bool delayed = false;
     if (m_files->rootPath() != cdir.absolutePath()) {
-        delayed = true;
-        // this can take a moment to feed the model
-        connect(m_files, &QFileSystemModel::directoryLoaded, this, [=](const QString &path) {
-                        if (path == m_files->rootPath()) {
-                            m_files->sort(0);
-                            filter(ffilter, Begin);
-                            insertToken(true);
-                        }
-                        cycleResults = true;
-                        }, Qt::SingleShotConnection);
-        m_files->setRootPath(cdir.absolutePath());
+        m_files->setRootPath(cdir.absolutePath()); // read right away
         force = true;
     }
     if (force) {
-        QModelIndex newRoot = m_files->index(m_files->rootPath());
         m_list->setCurrentIndex(QModelIndex());
-        m_list->setRootIndex(newRoot);
+        previousMatches.clear();
         previousNeedle.clear();
-        if (!delayed) {
-            filter(ffilter, Begin);
-        }
+        filter(ffilter, Begin);
     }
-    if (!delayed)
-        insertToken(true);
+    insertToken(true);
     cycleResults = true; // last because reset by filtering
 }
 
+void Qiq::findFiles() {
+    if (!m_found) {
+        m_found = new QStandardItemModel(this);
+        m_finder = new FileFinder(this);
+        // new rows only show up if they match, but that's not redone for every batch
+        QTimer *refilter = new QTimer(this);
+        refilter->setSingleShot(true);
+        refilter->setInterval(500);
+        connect(refilter, &QTimer::timeout, this, [=]() {
+            if (currentWidget() == m_list && m_results->sourceModel() == m_found && m_results->isFiltered())
+                filterInput();
+        });
+        connect(m_finder, &FileFinder::found, this, [=](const QStringList &paths) {
+            QList<QStandardItem*> items;
+            items.reserve(paths.size());
+            for (const QString &path : paths)
+                items << new QStandardItem(path);
+            m_found->invisibleRootItem()->appendRows(items); // one insertion
+            if (!refilter->isActive())
+                refilter->start();
+        });
+        connect(m_finder, &FileFinder::finished, this, [=]() {
+            setStyleFlag(m_input, "finding", false);
+            refilter->start(0); // the last batch
+        });
+    }
+    m_finder->cancel();
+    m_found->clear();
+    setModel(m_found);
+    setCurrentWidget(m_list);
+    previousNeedle.clear();
+    setStyleFlag(m_input, "finding", true);
+    m_finder->start(QDir::currentPath());
+    filterInput();
+}
+
 void Qiq::explicitlyComplete() {
+    if (m_cmdCompleter->isPending())
+        return; // still on it, typing cancels it
     const QString lastToken = m_input->text().left(m_input->cursorPosition()).section(whitespace, -1, -1);
     if (currentWidget() != m_list)
         cycleResults = false;
@@ -1163,18 +1345,19 @@ void Qiq::explicitlyComplete() {
         QKeyEvent ke(QEvent::KeyPress, Qt::Key_Down, Qt::NoModifier);
         m_list->setEnabled(true);
         QApplication::sendEvent(m_list, &ke);
+        if (oldIndex == m_list->currentIndex() && m_results->rowCount() < m_results->matchCount()) {
+            // end of the ranked batch, not of the matches
+            m_results->fetchMore(QModelIndex());
+            QApplication::sendEvent(m_list, &ke);
+        }
         if (oldIndex == m_list->currentIndex()) {
             QKeyEvent ke(QEvent::KeyPress, Qt::Key_Home, Qt::NoModifier);
             QApplication::sendEvent(m_list, &ke);
-            if (m_list->isRowHidden(0)) {
-                QKeyEvent ke(QEvent::KeyPress, Qt::Key_Down, Qt::NoModifier);
-                QApplication::sendEvent(m_list, &ke);
-            }
         }
         insertToken(false);
         return;
     }
-    if (currentWidget() == m_list && m_list->model() == m_cmdHistory) {
+    if (currentWidget() == m_list && m_results->sourceModel() == m_cmdHistory) {
         cycleResults = true;
         if (insertToken(false))
             return;
@@ -1231,6 +1414,31 @@ void Qiq::explicitlyComplete() {
         completeDir(dir, false, fileInfo.fileName());
         return;
     }
+
+    // no such path (yet), try to jump to a frecent one by a few characters of it
+    const bool cd = m_input->text().startsWith("cd ");
+    if ((cd && !lastToken.contains('/')) || (lastToken.contains('/') && !lastToken.startsWith('"'))) {
+        QStringList frecent = m_frecency->query(lastToken.split('/', Qt::SkipEmptyParts), cd ? Frecency::Dirs : Frecency::All);
+        if (!frecent.isEmpty()) {
+            const QString home = QDir::homePath() + '/';
+            for (QString &path : frecent) {
+                if (path.startsWith(home))
+                    path.replace(0, home.size() - 1, "~");
+                if (path.contains(whitespace))
+                    path = '"' + path + '"';
+            }
+            if (!m_cmdCompleted)
+                m_cmdCompleted = new QStringListModel(this);
+            m_cmdCompleted->setStringList(frecent);
+            setModel(m_cmdCompleted);
+            setCurrentWidget(m_list);
+            previousNeedle.clear();
+            filter("", Begin); // the token isn't a prefix of them, keep the ranking
+            insertToken(false);
+            cycleResults = true;
+            return;
+        }
+    }
     auto stripInstruction = [=](QString &token) {
         if (token.startsWith('=') || token.startsWith('?') || token.startsWith('!') || token.startsWith('#') || token.startsWith('&'))
             token.remove(0,1);
@@ -1239,21 +1447,46 @@ void Qiq::explicitlyComplete() {
     static const QRegularExpression leadingWS("^\\s*");
     lastCmd.remove(leadingWS);
     stripInstruction(lastCmd);
-    if (lastCmd.contains(whitespace) && m_bins->stringList().contains(lastCmd.section(whitespace, 0, 0).trimmed())) { // first token is a known binary
-        if (!m_cmdCompletion.isEmpty()) {
-            QProcess complete;
-            complete.start(m_cmdCompletion, QStringList() << lastCmd);
-            if (complete.waitForFinished(2000)) {
-                QStringList completions = QString::fromLocal8Bit(complete.readAllStandardOutput()).split('\n');
-                if (!completions.isEmpty() && completions.constLast().isEmpty())
-                    completions.removeLast();
-                if (!completions.isEmpty() && completions.constFirst().startsWith("__files"/*\r*/)) {
-                    completeDir(QDir::current(), true, fileInfo.fileName());
+    if (lastCmd.contains(whitespace) && m_binaries->contains(lastCmd.section(whitespace, 0, 0).trimmed())) { // first token is a known binary
+        if (!m_cmdCompleter->isEmpty()) {
+            // the completions trickle in, the first batch opens the list, later ones are added
+            static QMetaObject::Connection completion;
+            disconnect(completion);
+            const QString fileName = fileInfo.fileName();
+            completion = connect(m_cmdCompleter, &CmdCompleter::completed, this,
+                                 [=, shown = false, seen = QSet<QString>()](const QStringList &completions, bool done) mutable {
+                if (done)
+                    disconnect(completion);
+                if (completions.isEmpty())
+                    return;
+                if (!shown && completions.constFirst().startsWith("__files"/*\r*/)) {
+                    m_cmdCompleter->cancel();
+                    disconnect(completion);
+                    completeDir(QDir::current(), true, fileName);
                     return;
                 }
-                completions.removeDuplicates();
-                completeAnnotated(completions);
-            }
+                QStringList fresh;
+                for (const QString &c : completions) {
+                    if (!seen.contains(c)) {
+                        seen.insert(c);
+                        fresh << c;
+                    }
+                }
+                if (!shown) {
+                    shown = true;
+                    completeAnnotated(fresh);
+                    return;
+                }
+                if (fresh.isEmpty() || m_results->sourceModel() != m_cmdCompleted)
+                    return;
+                const int row = m_cmdCompleted->rowCount();
+                m_cmdCompleted->insertRows(row, fresh.size());
+                for (int i = 0; i < fresh.size(); ++i)
+                    m_cmdCompleted->setData(m_cmdCompleted->index(row + i), fresh.at(i));
+                filter(previousNeedle, Begin);
+            });
+            m_cmdCompleter->request(lastCmd);
+            return; // cycling starts with the list
         }
     } else {
         setModel(m_bins);
@@ -1278,64 +1511,176 @@ void Qiq::tokenUnderCursor(int &left, int &right) {
     }
 }
 
-void Qiq::filter(const QString needle, MatchType matchType) {
+// a newer needle supersedes whatever is still scanned
+static QAtomicInt filterGeneration;
+static QFuture<FilterChunk> runningFilter;
+
+void Qiq::filter(const QString needle, MatchType matchType, bool background) {
+    filterGeneration.ref();
+    runningFilter.cancel();
     if (!needle.isNull()) // artificial to prime geometry adjustment
         cycleResults = false;
-    if (!m_list->model())
+    QAbstractItemModel *model = m_results->sourceModel();
+    if (!model)
         return;
     bool shrink = false;
-    const int rows = m_list->model()->rowCount(m_list->rootIndex());
-    int visible = 0;
-    static int prevVisible = 0;
-    int firstVisRow = m_lastVisibleRow = -1;
-    bool matchPartial = matchType == Partial;
-
-    if (m_list->model() == m_applications) {
-        matchPartial = false;
-        QStringList tokens = needle.split(whitespace, Qt::SkipEmptyParts);
-        for (int i = 0; i < rows; ++i) {
-            const QModelIndex idx = m_list->model()->index(i, 0, m_list->rootIndex());
-            bool vis = false;
-            int score = 0;
-            for (const QString &token : tokens) {
-                const QString hay = idx.data().toString();
-                if (!hay.isEmpty()) {
-                    if ((vis = hay.startsWith(token, Qt::CaseInsensitive))) {  score += 100 + 100*token.length()/hay.length(); continue; }
-                    if ((vis = hay.contains(token, Qt::CaseInsensitive))) {  score += 50 + 50*token.length()/hay.length(); continue; }
-                }
-                if ((vis = idx.data(AppExec).toString().contains(token, Qt::CaseInsensitive))) { score += 25; continue; }
-                if ((vis = idx.data(AppComment).toString().contains(token, Qt::CaseInsensitive))) { score += 10; continue; }
-                const QStringList cats = idx.data(AppCategories).toStringList();
-                for (const QString &cat : cats) {
-                    if ((vis = cat.contains(token, Qt::CaseInsensitive))) break;
-                }
-                const QStringList keys = idx.data(AppKeywords).toStringList();
-                for (const QString &key : keys) {
-                    if ((vis = key.contains(token, Qt::CaseInsensitive))) break;
+    const QModelIndex root = m_results->root();
+    const int rows = model->rowCount(root);
+    MatchType matched = matchType; // what it came down to after the fallbacks
+
+    // the character masks of the rows, for the fuzzy prefilter
+    static struct {
+        const QAbstractItemModel *model = nullptr;
+        QPersistentModelIndex root;
+        QList<quint64> masks;
+    } charMasks;
+    static QSet<const QAbstractItemModel*> watchedModels;
+    if (!watchedModels.contains(model)) {
+        watchedModels.insert(model);
+        // any structural change voids the previous matches, icons trickling in don't
+        auto forget = [=]() {
+            if (previousMatches.model == model)
+                previousMatches.clear();
+            if (charMasks.model == model) {
+                charMasks.model = nullptr;
+                charMasks.masks.clear();
+            }
+        };
+        connect(model, &QAbstractItemModel::modelReset, this, forget);
+        connect(model, &QAbstractItemModel::rowsInserted, this, [=](const QModelIndex &parent, int first, int last) {
+            if (previousMatches.model == model)
+                previousMatches.clear();
+            // streamed lists grow a batch at a time, only that one needs its masks
+            if (charMasks.model == model && charMasks.root == parent) {
+                charMasks.masks.insert(first, last - first + 1, 0);
+                for (int i = first; i <= last; ++i)
+                    charMasks.masks[i] = FuzzyMatcher::charMask(model->index(i, 0, parent).data().toString());
+            }
+        });
+        connect(model, &QAbstractItemModel::rowsRemoved, this, forget);
+        connect(model, &QAbstractItemModel::rowsMoved, this, forget);
+        connect(model, &QAbstractItemModel::layoutChanged, this, forget);
+        connect(model, &QAbstractItemModel::dataChanged, this, [=](const QModelIndex &, const QModelIndex &, const QList<int> &roles) {
+            if (roles != QList<int>{Qt::DecorationRole})
+                forget();
+        });
+    }
+    auto narrows = [&](MatchType type) {
+        return previousMatches.model == model && previousMatches.root == root && m_results->isFiltered() &&
+               previousMatches.type == type && !previousMatches.needle.isEmpty() &&
+               needle.startsWith(previousMatches.needle, Qt::CaseInsensitive);
+    };
+    // the rows that still can match, either the last matches or everything
+    auto candidates = [&](MatchType type) {
+        if (narrows(type))
+            return m_results->sourceRows();
+        QList<int> all(rows);
+        std::iota(all.begin(), all.end(), 0);
+        return all;
+    };
+    auto fuzzyTokens = [&](bool fold) {
+        QList<FuzzyMatcher> matchers;
+        const QStringList tokens = needle.split(whitespace, Qt::SkipEmptyParts);
+        for (const QString &token : tokens)
+            matchers << FuzzyMatcher(fold ? SearchTable::fold(token) : token);
+        return matchers;
+    };
+    const bool gathered = gatherHaystack();
+    auto textAt = [&](int row) {
+        return gathered ? haystack.texts.at(row) : model->index(row, 0, root).data().toString();
+    };
+    // the rows that can contain all tokens, as far as the trigrams tell
+    auto partialCandidates = [&](const QStringList &tokens) {
+        if (!gathered || !haystack.indexed || narrows(Partial))
+            return candidates(Partial);
+        QList<int> found;
+        if (haystack.index.lookup(tokens, found))
+            return found;
+        return candidates(Partial);
+    };
+    // hands large scans to the thread pool and shows the matches once they're in
+    auto scanInBackground = [&](const QList<int> &rowsToScan, MatchType type, const QStringList &tokens, bool rank) {
+        if (!background || !gathered || rowsToScan.size() < BACKGROUND_ROWS)
+            return false;
+        const int generation = filterGeneration.loadRelaxed();
+        const QStringList texts = haystack.texts;
+        const QList<FuzzyMatcher> matchers = type == Fuzzy ? fuzzyTokens(false) : QList<FuzzyMatcher>();
+        QList<QList<int>> chunks;
+        const int chunkSize = qMax(4096, int(rowsToScan.size() / (4*QThread::idealThreadCount())));
+        for (int i = 0; i < rowsToScan.size(); i += chunkSize)
+            chunks << rowsToScan.mid(i, chunkSize);
+        QFutureWatcher<FilterChunk> *watcher = new QFutureWatcher<FilterChunk>(this);
+        connect(watcher, &QFutureWatcher<FilterChunk>::finished, this, [=]() {
+            watcher->deleteLater();
+            if (watcher->isCanceled() || generation != filterGeneration.loadRelaxed())
+                return; // superseded
+            if (m_results->sourceModel() != model || m_results->root() != root)
+                return; // somebody else took the list
+            if (haystack.model != model)
+                return filter(needle, type); // the list changed meanwhile
+            QList<int> matches, scores;
+            for (const FilterChunk &chunk : watcher->future().results()) {
+                matches << chunk.rows;
+                scores << chunk.scores;
+            }
+            if (matches.isEmpty() && type == Partial && !tokens.isEmpty() && (model == m_external || model == m_found))
+                return filter(needle, Fuzzy, true); // maybe it's scattered
+            showMatches(needle, type, previousNeedle.contains(needle, Qt::CaseInsensitive), matches, scores);
+        });
+        runningFilter = QtConcurrent::mapped(chunks, [=](const QList<int> &chunk) {
+            FilterChunk result;
+            for (int i = 0; i < chunk.size(); ++i) {
+                if (!(i & 1023) && generation != filterGeneration.loadRelaxed())
+                    break; // superseded, the result won't be used
+                const int row = chunk.at(i);
+                const int score = type == Fuzzy ? fuzzyScore(texts.at(row), matchers) : partialScore(texts.at(row), tokens, needle, rank);
+                if (score < 0)
+                    continue;
+                result.rows << row;
+                if (type == Fuzzy || rank)
+                    result.scores << score;
+            }
+            return result;
+        });
+        watcher->setFuture(runningFilter);
+        return true;
+    };
+    QList<int> matches, scores;
+
+    if (model == m_applications) {
+        if (matched != Fuzzy) {
+            matched = Partial;
+            QStringList tokens = needle.split(whitespace, Qt::SkipEmptyParts);
+            for (QString &token : tokens)
+                token = SearchTable::fold(token);
+            // if only the fuzzy fallback matched the shorter needle, the tokens can't be found anyway
+            if (!narrows(Fuzzy)) {
+                for (int i : candidates(Partial)) {
+                    const int score = m_applications->score(i, tokens);
+                    if (score > -1) {
+                        matches << i;
+                        scores << score;
+                    }
                 }
-                if (!vis) break;
             }
-            m_applications->setData(idx, score, MatchScore);
-            m_list->setRowHidden(i, !(vis && ++visible));
-        }
-        if (!needle.isEmpty()) {
-            m_applications->setSortRole(MatchScore);
-            m_applications->sort(0, Qt::DescendingOrder);
-        }
-        for (int i = 0; i < rows; ++i) {
-            if (!m_list->isRowHidden(i)) {
-                m_lastVisibleRow = i;
-                if (firstVisRow < 0) {
-                    firstVisRow = i;
-                    m_list->setCurrentIndex(m_list->model()->index(firstVisRow, 0, m_list->rootIndex()));
+            if (matches.isEmpty() && !tokens.isEmpty())
+                matched = Fuzzy;
+        }
+        if (matched == Fuzzy) {
+            const QList<FuzzyMatcher> tokens = fuzzyTokens(true);
+            for (int i : candidates(Fuzzy)) {
+                const int score = m_applications->fuzzyScore(i, tokens);
+                if (score > -1) {
+                    matches << i;
+                    scores << score;
                 }
             }
         }
-    } else if (m_list->model() == m_notifications->model()) {
-        matchPartial = false;
+    } else if (model == m_notifications->model()) {
+        matched = Partial;
         QStringList tokens = needle.split(whitespace);
-        for (int i = 0; i < rows; ++i) {
-            const QModelIndex idx = m_list->model()->index(i, 0, m_list->rootIndex());
+        for (int i : partialCandidates(tokens)) {
+            const QModelIndex idx = model->index(i, 0, root);
             bool vis = false;
             for (const QString &token : tokens) {
                 if ((vis = idx.data().toString().contains(token, Qt::CaseInsensitive))) continue;
@@ -1343,84 +1688,177 @@ void Qiq::filter(const QString needle, MatchType matchType) {
                 if ((vis = idx.data(Notifications::AppName).toString().contains(token, Qt::CaseInsensitive))) continue;
                 if (!vis) break;
             }
-            if (vis) {
-                m_lastVisibleRow = i;
-                if (firstVisRow < 0)
-                    firstVisRow = i;
-            }
-            m_list->setRowHidden(i, !(vis && ++visible));
-        }
-    } else if (matchType == Begin) {
-        matchPartial = false;
-        const bool filterDot = (m_list->model() == m_files) && !needle.startsWith('.');
-        for (int i = 0; i < rows; ++i) {
-            const QString hay = m_list->model()->index(i, 0, m_list->rootIndex()).data().toString();
-            const bool vis = !(filterDot && hay.startsWith('.')) && hay.startsWith(needle, Qt::CaseInsensitive);
-            if (vis) {
-                m_lastVisibleRow = i;
-                if (firstVisRow < 0)
-                    firstVisRow = i;
-            }
-            m_list->setRowHidden(i, !(vis && ++visible));
-        }
-        shrink = previousNeedle.startsWith(needle, Qt::CaseInsensitive);
-        if (!visible && rows > 0 && m_list->model() == m_files)
-            matchPartial = true;
-    }
-    if (matchPartial) { // if (matchType == Partial)
-        QStringList sl = needle.split(whitespace, Qt::SkipEmptyParts);
-        QStandardItemModel *takeScores = nullptr;
-        if (!needle.isEmpty())
-            takeScores = qobject_cast<QStandardItemModel*>(m_list->model());
-        for (int i = 0; i < rows; ++i) {
-            QModelIndex index = m_list->model()->index(i, 0, m_list->rootIndex());
-            const QString &hay = index.data().toString();
-            bool vis = true;
-            for (const QString &s : sl) {
-                if (!hay.contains(s, Qt::CaseInsensitive)) {
-                    vis = false;
-                    break;
+            if (vis)
+                matches << i;
+        }
+    } else {
+        if (matched == Begin) {
+            const bool filterDot = (model == m_files) && !needle.startsWith('.');
+            if (model == m_bins && root == QModelIndex()) {
+                // sorted, so the completions are a range
+                int first, last;
+                m_binaries->prefixRange(needle, first, last);
+                matches.resize(last - first);
+                std::iota(matches.begin(), matches.end(), first);
+            } else if (!(model == m_files && narrows(Partial))) {
+                // if nothing began with the shorter needle, nothing will begin with this one
+                for (int i : candidates(Begin)) {
+                    const QString hay = model->index(i, 0, root).data().toString();
+                    if (!(filterDot && hay.startsWith('.')) && hay.startsWith(needle, Qt::CaseInsensitive))
+                        matches << i;
                 }
             }
-            if (takeScores) {
-                int score = 0;
-                if (vis) {
-                    score = 1;
-                    if (hay.startsWith(needle))
-                        score = 100;
-                    else if (hay.contains(needle))
-                        score = 50;
+            shrink = previousNeedle.startsWith(needle, Qt::CaseInsensitive);
+            if (matches.isEmpty() && rows > 0 && model == m_files)
+                matched = Partial;
+        }
+        if (matched == Partial) {
+            QStringList sl = needle.split(whitespace, Qt::SkipEmptyParts);
+            const bool rank = !needle.isEmpty() && qobject_cast<QStandardItemModel*>(model);
+            if (!((model == m_external || model == m_found) && narrows(Fuzzy))) {
+                const QList<int> rowsToScan = partialCandidates(sl);
+                if (scanInBackground(rowsToScan, Partial, sl, rank))
+                    return;
+                for (int i : rowsToScan) {
+                    const int score = partialScore(textAt(i), sl, needle, rank);
+                    if (score < 0)
+                        continue;
+                    matches << i;
+                    if (rank)
+                        scores << score;
                 }
-                takeScores->setData(index, score, MatchScore);
             }
-            m_list->setRowHidden(i, !(vis && ++visible));
-        }
-        if (takeScores) {
-            takeScores->setSortRole(MatchScore);
-            takeScores->sort(0, Qt::DescendingOrder);
-        }
-        // sorting unfortunately trashes the order, so we need a second pass for that
-        // (not special cased for the rare occasion of !takeScores)
-        for (int i = 0; i < rows; ++i) {
-            if (!m_list->isRowHidden(i)) {
-                m_lastVisibleRow = i;
-                if (firstVisRow < 0)
-                    firstVisRow = i;
+            shrink = previousNeedle.contains(needle, Qt::CaseInsensitive);
+            // maybe it's scattered
+            if (matches.isEmpty() && !sl.isEmpty() && (model == m_external || model == m_found))
+                matched = Fuzzy;
+        }
+        if (matched == Fuzzy) {
+            const QList<FuzzyMatcher> tokens = fuzzyTokens(false);
+            if (charMasks.model != model || charMasks.root != root) {
+                charMasks.model = model;
+                charMasks.root = root;
+                charMasks.masks.resize(rows);
+                for (int i = 0; i < rows; ++i)
+                    charMasks.masks[i] = FuzzyMatcher::charMask(textAt(i));
+            }
+            quint64 needed = 0;
+            for (const FuzzyMatcher &token : tokens)
+                needed |= token.mask();
+            QList<int> rowsToScore;
+            if (narrows(Fuzzy)) {
+                for (int i : m_results->sourceRows())
+                    if ((charMasks.masks.at(i) & needed) == needed)
+                        rowsToScore << i;
+            } else {
+                rowsToScore = FuzzyMatcher::prefilter(charMasks.masks, needed);
+            }
+            if (scanInBackground(rowsToScore, Fuzzy, QStringList(), false))
+                return;
+            for (int i : rowsToScore) {
+                const int score = fuzzyScore(textAt(i), tokens);
+                if (score > -1) {
+                    matches << i;
+                    scores << score;
+                }
             }
+            shrink = previousNeedle.contains(needle, Qt::CaseInsensitive);
         }
-        shrink = previousNeedle.contains(needle, Qt::CaseInsensitive);
     }
+    showMatches(needle, matched, shrink, matches, scores);
+}
+
+bool Qiq::gatherHaystack() {
+    QAbstractItemModel *model = m_results->sourceModel();
+    const QModelIndex root = m_results->root();
+    const bool notifications = model && model == m_notifications->model();
+    if (!model || model->rowCount(root) < TRIGRAM_ROWS ||
+        !(model == m_external || model == m_cmdHistory || model == m_found || notifications))
+        return false;
+    if (haystack.model == model && haystack.root == root)
+        return true;
+    static QSet<const QAbstractItemModel*> watchedModels;
+    if (!watchedModels.contains(model)) {
+        watchedModels.insert(model);
+        auto forget = [=]() {
+            if (haystack.model == model)
+                haystack.clear();
+        };
+        connect(model, &QAbstractItemModel::modelReset, this, forget);
+        connect(model, &QAbstractItemModel::rowsInserted, this, forget);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, forget);
+        connect(model, &QAbstractItemModel::rowsMoved, this, forget);
+        connect(model, &QAbstractItemModel::layoutChanged, this, forget);
+        connect(model, &QAbstractItemModel::dataChanged, this, [=](const QModelIndex &, const QModelIndex &, const QList<int> &roles) {
+            if (roles != QList<int>{Qt::DecorationRole})
+                forget();
+        });
+    }
+    haystack.clear();
+    // the model can only be read here, the trigrams of what it says can be made anywhere
+    const int rows = model->rowCount(root);
+    QStringList keys;
+    haystack.texts.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        const QModelIndex idx = model->index(i, 0, root);
+        haystack.texts << idx.data().toString();
+        if (notifications)
+            keys << haystack.texts.last() + '\n' + idx.data(Qt::ToolTipRole).toString() + '\n' + idx.data(Notifications::AppName).toString();
+    }
+    if (!notifications)
+        keys = haystack.texts;
+    haystack.model = model;
+    haystack.root = root;
+    const int generation = haystack.generation;
+    QFutureWatcher<TrigramIndex> *watcher = new QFutureWatcher<TrigramIndex>(this);
+    connect(watcher, &QFutureWatcher<TrigramIndex>::finished, this, [=]() {
+        watcher->deleteLater();
+        if (generation != haystack.generation)
+            return; // the list changed meanwhile
+        haystack.index = watcher->result();
+        haystack.indexed = true;
+    });
+    watcher->setFuture(QtConcurrent::run([keys]() {
+        TrigramIndex index;
+        for (const QString &key : keys)
+            index.append(key);
+        return index;
+    }));
+    return true;
+}
+
+void Qiq::showMatches(const QString &needle, MatchType matched, bool shrink, const QList<int> &matches, const QList<int> &scores) {
+    static int prevVisible = 0;
+    QAbstractItemModel *model = m_results->sourceModel();
+    const QModelIndex root = m_results->root();
+    // keep the current entry if it still matches
+    const int currentRow = m_results->mapToSource(m_list->currentIndex()).row();
+    if (matches.size() == model->rowCount(root) && scores.isEmpty())
+        m_results->showAll();
+    else
+        m_results->setRows(matches, scores);
+    const int visible = m_results->matchCount();
+    m_lastVisibleRow = m_results->rowCount() - 1; // only the top ranks are around yet
+    if (model == m_applications) {
+        if (visible)
+            m_list->setCurrentIndex(m_results->index(0, 0));
+    } else if (currentRow > -1) {
+        m_list->setCurrentIndex(m_results->mapFromSource(model->index(currentRow, 0, root)));
+    }
+    previousMatches.model = model;
+    previousMatches.root = root;
+    previousMatches.needle = needle;
+    previousMatches.type = matched;
     if (!needle.isEmpty())
         previousNeedle = needle;
-    const int row = m_list->currentIndex().row();
     bool looksLikeCommand = false;
-    if (m_list->currentIndex().isValid() && (m_list->model() == m_applications || m_list->model() == m_external))
-        looksLikeCommand = m_input->text().contains(" | ") || (m_input->text().trimmed().contains(whitespace) && m_bins->stringList().contains(m_input->text().split(whitespace).first()));
+    if (m_list->currentIndex().isValid() && (m_results->sourceModel() == m_applications || m_results->sourceModel() == m_external))
+        looksLikeCommand = m_input->text().contains(" | ") || (m_input->text().trimmed().contains(whitespace) && m_binaries->contains(m_input->text().split(whitespace).first()));
     if (looksLikeCommand) {
         // if the user seems to enter a command, unselect any entries and force reselection
         m_list->setCurrentIndex(QModelIndex());
-    } else if (visible > 0 && (row < 0 || m_list->isRowHidden(row))) {
-        m_list->setCurrentIndex(m_list->model()->index(firstVisRow, 0, m_list->rootIndex()));
+    } else if (visible > 0 && !m_list->currentIndex().isValid()) {
+        m_list->setCurrentIndex(m_results->index(0, 0));
     } else if (!visible || (visible > 1 && shrink && prevVisible == 1)) {
         m_list->setCurrentIndex(QModelIndex());
     }
@@ -1434,14 +1872,19 @@ void Qiq::filter(const QString needle, MatchType matchType) {
 }
 
 void Qiq::filterInput() {
-    if (m_list->model() == m_applications || m_list->model() == m_external || m_list->model() == m_cmdHistory)
-        return filter(m_input->text(), Partial);
+    if (m_results->sourceModel() == m_applications || m_results->sourceModel() == m_external || m_results->sourceModel() == m_cmdHistory)
+        return filter(m_input->text(), m_fuzzy ? Fuzzy : Partial, true);
 
     QString text = m_input->text();
     int left, right;
     tokenUnderCursor(left, right);
     text = text.mid(left, right - left);
-    if (m_list->model() == m_files) {
+    if (m_results->sourceModel() == m_found) {
+        if (text.startsWith('"'))
+            text.remove(0,1);
+        return filter(text, m_fuzzy ? Fuzzy : Partial, true); // it can get long
+    }
+    if (m_results->sourceModel() == m_files) {
         if (text.trimmed().isEmpty()) {
             setModel(m_applications);
             return filter(m_input->text(), Partial);
@@ -1458,21 +1901,19 @@ void Qiq::filterInput() {
         if (path != m_files->rootPath()) {
             m_files->setRootPath(path);
             m_list->setCurrentIndex(QModelIndex());
-            QModelIndex newRoot = m_files->index(m_files->rootPath());
-            m_list->setRootIndex(newRoot);
-            m_files->fetchMore(newRoot);
+            previousMatches.clear();
         }
         text = fileInfo.fileName();
-    } else if (m_list->model() == m_bins && text.isEmpty()) {
+    } else if (m_results->sourceModel() == m_bins && text.isEmpty()) {
         setCurrentWidget(m_status);
     }
     filter(text, Begin);
 }
 
 bool Qiq::insertToken(bool selectDiff) {
-    if (m_list->model() == m_applications)
+    if (m_results->sourceModel() == m_applications)
         return false; // nope. Never.
-    if (m_list->model() == m_external) {
+    if (m_results->sourceModel() == m_external) {
         if (m_externCmd == "_qiq") { // this is because if the user wants the output as a list they might want to do some with those values
             m_input->setText(m_list->currentIndex().data().toString());
             return true;
@@ -1480,15 +1921,17 @@ bool Qiq::insertToken(bool selectDiff) {
         return false;
     }
     QString newToken = m_list->currentIndex().data().toString();
-    if (m_list->model() == m_files) {
+    if (m_results->sourceModel() == m_files || m_results->sourceModel() == m_found) {
         if (newToken.isEmpty())
             return false;
         // preserve present token to not screw the users input
         int left, right;
         tokenUnderCursor(left, right);
         QString token = m_input->text().mid(left, right - left);
-        int slash = token.lastIndexOf(QDir::separator());
-        newToken = token.left(slash + 1) + newToken;
+        if (m_results->sourceModel() == m_files) { // the found ones are relative to the current dir already
+            int slash = token.lastIndexOf(QDir::separator());
+            newToken = token.left(slash + 1) + newToken;
+        }
         for (const QString &cmd : m_previewCmds) {
             if (m_input->text().startsWith(cmd)) {
                 // need canonical path for preview
@@ -1510,7 +1953,7 @@ bool Qiq::insertToken(bool selectDiff) {
         } else if (newToken.startsWith("\"")) {
             newToken.remove(0,1);
         }
-    } else if (m_list->model() == m_cmdHistory) {
+    } else if (m_results->sourceModel() == m_cmdHistory) {
         if (newToken.isEmpty())
             return false;
         int pos = selectDiff ? newToken.indexOf(m_input->text(), 0, Qt::CaseInsensitive) + m_input->cursorPosition() : -1;
@@ -1518,7 +1961,7 @@ bool Qiq::insertToken(bool selectDiff) {
         if (pos > -1)
             m_input->setSelection(pos, newToken.length());
         return true;
-    } else if (m_list->model() == m_cmdCompleted) {
+    } else if (m_results->sourceModel() == m_cmdCompleted) {
         if (!m_cmdCompletionSep.isEmpty()) {
             newToken = newToken.section(m_cmdCompletionSep, 0, 0);
             newToken.remove('\r'); // zsh completions at times at least have that, probably to control the cursor
@@ -1538,7 +1981,7 @@ bool Qiq::insertToken(bool selectDiff) {
         const QChar firstChar = text.at(left);
         if (firstChar == '=' || firstChar == '?' || firstChar == '!' || firstChar == '#')
             ++left;
-        if (m_list->model() == m_files && newToken.startsWith('"') && !text.isEmpty() && text.at(left) != '"')
+        if ((m_results->sourceModel() == m_files || m_results->sourceModel() == m_found) && newToken.startsWith('"') && !text.isEmpty() && text.at(left) != '"')
             ++cursorOffset;
         text.replace(left, right - left, newToken);
         pos = -(left+newToken.size());
@@ -1590,71 +2033,191 @@ void Qiq::message(const QString &string) {
         adjustGeometry();
 }
 
+// what a process printed, read as it comes in so it doesn't pile up in the QProcess
+struct ProcessOutput {
+    ProcessOutput(qint64 limit, OutputBuffer::Mode mode) : out(new OutputBuffer(limit, mode))
+                                                         , err(qMin(limit, qint64(BROWSER_LIMIT)), OutputBuffer::Tail) {}
+    QSharedPointer<OutputBuffer> out; // shared with the OutputView, it outlives the process
+    OutputBuffer err;
+    QByteArray fresh; // not yet shown
+    AnsiConverter ansi;
+    bool stream = false; // ?commands are shown while they're still running
+    bool plain = true; // html has to wait for the whole thing
+    bool shown = false;
+    bool viewed = false; // by the OutputView
+};
+static QHash<const QProcess*, QSharedPointer<ProcessOutput>> processOutputs;
+
+static void appendText(QTextBrowser *disp, AnsiConverter &ansi, const QByteArray &text) {
+    QScrollBar *bar = disp->verticalScrollBar();
+    const bool follow = bar->value() == bar->maximum();
+    QTextCursor cursor(disp->document());
+    cursor.movePosition(QTextCursor::End);
+    ansi.insert(cursor, text);
+    if (follow)
+        bar->setValue(bar->maximum());
+}
+
+void Qiq::captureOutput(QProcess *process) {
+    QSharedPointer<ProcessOutput> previous = processOutputs.value(process);
+    QSharedPointer<ProcessOutput> output = QSharedPointer<ProcessOutput>::create(m_outputLimit, m_outputTail ? OutputBuffer::Tail : OutputBuffer::Spill);
+    processOutputs.insert(process, output);
+    if (previous) { // restarted (sudo), start over
+        output->stream = process->property("qiq_type").toString() == "stdout";
+        return;
+    }
+    connect(process, &QObject::destroyed, this, [=]() { processOutputs.remove(process); });
+    connect(process, &QProcess::readyReadStandardError, this, [=]() {
+        if (QSharedPointer<ProcessOutput> capture = processOutputs.value(process))
+            capture->err.append(process->readAllStandardError());
+    });
+    // no more than once a frame
+    QTimer *frame = new QTimer(process);
+    frame->setSingleShot(true);
+    frame->setInterval(16);
+    connect(process, &QProcess::readyReadStandardOutput, this, [=]() {
+        QSharedPointer<ProcessOutput> capture = processOutputs.value(process);
+        if (!capture)
+            return;
+        const QByteArray chunk = process->readAllStandardOutput();
+        capture->out->append(chunk);
+        if (!capture->stream || !capture->plain)
+            return;
+        capture->fresh += chunk;
+        if (!frame->isActive())
+            frame->start();
+    });
+    connect(frame, &QTimer::timeout, this, [=]() { streamOutput(process); });
+}
+
+void Qiq::streamOutput(QProcess *process) {
+    QSharedPointer<ProcessOutput> output = processOutputs.value(process);
+    if (!output || !output->stream || !output->plain || output->fresh.isEmpty())
+        return;
+    QByteArray chunk = output->fresh;
+    output->fresh.clear();
+    if (process->property("%clip%").toBool() ||
+        (!output->shown && mightBeRichText(QString::fromLocal8Bit(output->out->read(0, 512))))) {
+        output->plain = false;
+        return;
+    }
+    const bool tail = output->out->mode() == OutputBuffer::Tail;
+    if (!tail && output->out->total() > BROWSER_LIMIT) { // too much for the browser
+        if (!output->viewed) {
+            output->viewed = output->shown = true;
+            m_autoHide.stop();
+            m_view->setBuffer(output->out);
+            setCurrentWidget(m_view);
+        } else if (m_view->buffer() == output->out) {
+            m_view->refresh();
+        }
+        return;
+    }
+    if (chunk.size() > BROWSER_LIMIT)
+        chunk = chunk.right(BROWSER_LIMIT);
+    if (!output->shown) {
+        output->shown = true;
+        message("<pre>" + output->ansi.toHtml(chunk) + "</pre>");
+        return;
+    }
+    appendText(m_disp, output->ansi, chunk);
+    if (tail) { // keep only about a page of the top
+        QTextDocument *doc = m_disp->document();
+        if (doc->characterCount() > BROWSER_LIMIT) {
+            QTextCursor cursor(doc);
+            cursor.setPosition(doc->characterCount() - BROWSER_LIMIT, QTextCursor::KeepAnchor);
+            cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor);
+            cursor.removeSelectedText();
+        }
+    }
+    adjustGeometry();
+}
+
 void Qiq::printOutput(int exitCode) {
     QProcess *process = qobject_cast<QProcess*>(sender());
     if (!process) {
         qDebug() << "wtf got us here?" << sender();
         return;
     }
+    QSharedPointer<ProcessOutput> capture = processOutputs.value(process);
+    if (!capture) {
+        qDebug() << "output wasn't captured" << process->program();
+        return;
+    }
+    const QByteArray rest = process->readAllStandardOutput();
+    capture->out->append(rest);
+    capture->err.append(process->readAllStandardError());
+    if (capture->stream && !exitCode) {
+        capture->fresh += rest;
+        streamOutput(process); // most of it is there already
+    }
+    capture->stream = false; // printOutput() took over
+    capture->fresh.clear();
+    const QString type = process->property("qiq_type").toString();
+    const OutputBuffer &out = *capture->out;
+    // json and csv go into the tree, even if they were streamed as text
+    bool json = false;
+    char separator = 0;
+    if (m_structuredOutput && !exitCode && !out.dropped() && out.size() && !process->property("%clip%").toBool() &&
+        type != "math" && type != "list" && type != "notify") {
+        const QByteArray head = out.read(0, SNIFF_SIZE);
+        json = JsonModel::sniff(head, out.read(out.size() - 64, 64), out.size() <= SNIFF_SIZE);
+        if (!json)
+            separator = CsvModel::sniff(head, out.size() <= SNIFF_SIZE);
+    }
+    const bool structured = json || separator;
+    // a tail that outgrew the browser is shown again in the OutputView
+    if (!structured && capture->shown && capture->plain && !exitCode && (capture->viewed || capture->out->total() <= BROWSER_LIMIT)) {
+        m_autoHide.stop();
+        return;
+    }
     QString output;
     if (exitCode) {
         m_history.removeAll(process->property("qiq_cmdline").toString());
         output = "<h3 align=center style=\"color:#d01717;\">" + process->program() + " " + process->arguments().join(" ") + "</h3><pre style=\"color:#d01717;\">";
-        QByteArray error = process->readAllStandardError();
-        if (!error.isEmpty()) {
-            output += QString::fromLocal8Bit(error).toHtmlEscaped();
+        if (capture->err.size()) {
+            if (capture->err.dropped())
+                output += "…\n";
+            output += QString::fromLocal8Bit(capture->err.read(0, capture->err.size())).toHtmlEscaped();
         output += "</pre>";
         }
     } else {
         m_disp->setTextColor(m_disp->palette().color(m_disp->foregroundRole()));
     }
     bool showAsList = false;
-    QByteArray stdout = process->readAllStandardOutput();
+    bool view = false;
+    // everything else gets no more than what was in memory anyway
+    QByteArray stdout = out.read(0, m_outputLimit);
     if (process->property("%clip%").toBool()) {
         QString string = QString::fromLocal8Bit(stdout);
         QGuiApplication::clipboard()->setText(string, QClipboard::Clipboard);
         QGuiApplication::clipboard()->setText(string, QClipboard::Selection);
-        stdout.clear();
         output += "<h3 align=center>" + tr("Copied to clipboard") + "</h3>";
+        if (stdout.size() < out.total())
+            output += "<p align=center>" + tr("only the first %1 of %2 bytes").arg(stdout.size()).arg(out.total()) + "</p>";
+        stdout.clear();
     }
     if (!stdout.isEmpty()) {
-        if (process->property("qiq_type").toString() == "math") {
+        if (type == "math") {
             output += "<pre align=center style=\"font-size:xx-large;\"><br><br>" + QString::fromLocal8Bit(stdout) + "</pre>";
-        } else if (process->property("qiq_type").toString() == "list") {
+        } else if (type == "list") {
             showAsList = true;
             output = QString::fromLocal8Bit(stdout);
-        } else if (mightBeRichText(QString::fromLocal8Bit(stdout.left(512)))) {
+        } else if (structured) {
+            // the models read from the buffer
+        } else if ((out.size() > BROWSER_LIMIT || out.dropped()) && type != "notify") {
+            view = true;
+        } else if (out.size() <= BROWSER_LIMIT && mightBeRichText(QString::fromLocal8Bit(stdout.left(512)))) {
             output += QString::fromLocal8Bit(stdout);
         } else {
-            if (m_aha.isNull()) {
-                if (m_bins->stringList().contains("ansifilter"))
-                    m_aha = "ansifilter -f -H";
-                else if (m_bins->stringList().contains("aha"))
-                    m_aha = "aha -x -n";
-                else
-                    m_aha = "";
-            }
-            if (!m_aha.isEmpty() && stdout.contains("\e[")) {
-                QProcess aha;
-                aha.startCommand(m_aha);
-                if (aha.waitForStarted(250)) {
-                    aha.write(stdout);
-                    aha.closeWriteChannel();
-                    if (aha.waitForFinished(250))
-                        stdout = aha.readAllStandardOutput();
-                }
-                output += "<pre>" + QString::fromLocal8Bit(stdout) + "</pre>";
-            } else {
-                output += "<pre>" + QString::fromLocal8Bit(stdout).toHtmlEscaped() + "</pre>";
-            }
+            output += "<pre>" + AnsiConverter().toHtml(stdout.left(BROWSER_LIMIT)) + "</pre>";
         }
     }
-    const QString type = process->property("qiq_type").toString();
-    if (output.isEmpty()) {
+    if (output.isEmpty() && !view && !structured) {
         if (type == "stdout" || type == "notify")
             output = "<h1 align=center>¯\\_(ツ)_/¯</h1><p align=center>" + tr("When you gaze long into the abyss, the abyss also gazes into you…") + "</p>";
     }
-    if (output.isEmpty())
+    if (output.isEmpty() && !view && !structured)
         return; // really nothing to do
     if (type == "notify") {
         notifyUser(process->program() + " " + process->arguments().join(" "), output);
@@ -1678,6 +2241,28 @@ void Qiq::printOutput(int exitCode) {
             setCurrentWidget(m_list);
         else
             adjustGeometry();
+    } else if (structured) {
+        if (separator) {
+            m_csv->setBuffer(capture->out, separator);
+            m_tree->setModel(m_csv);
+            m_tree->setRootIsDecorated(false);
+        } else {
+            m_json->setBuffer(capture->out);
+            m_tree->setModel(m_json);
+            m_tree->setRootIsDecorated(true);
+        }
+        m_tree->header()->resizeSections(QHeaderView::ResizeToContents);
+        m_tree->setCurrentIndex(m_tree->model()->index(0, 0));
+        if (currentWidget() != m_tree)
+            setCurrentWidget(m_tree);
+    } else if (view) {
+        if (out.dropped()) {
+            output += "<p align=center style=\"color:#888;\">" + (out.mode() == OutputBuffer::Tail ? tr("%1 bytes before this were dropped")
+                                                                                                 : tr("%1 bytes after this are missing")).arg(out.dropped()) + "</p>";
+        }
+        m_view->setBuffer(capture->out, output);
+        if (currentWidget() != m_view)
+            setCurrentWidget(m_view);
     } else {
         message(output);
     }
@@ -1721,7 +2306,7 @@ bool Qiq::runInput() {
     m_notifications->preview(QString()); // hide
     QAbstractItemModel *currentModel = nullptr;
     if (currentWidget() == m_list)
-        currentModel = m_list->model();
+        currentModel = m_results->sourceModel();
 
     // filter from custom list ==========================================================================================================
     if (currentModel && // m_external is lazily created
@@ -1874,6 +2459,17 @@ bool Qiq::runInput() {
         m_notifications->add("qiq", 0, "qiq", summary, QString(), QStringList(), hints, ms);
         return true;
     }
+    if (command.simplified().startsWith("qiq find")) {
+        if (!m_fileIndex->count()) {
+            if (m_fileIndex->isCrawling())
+                message(tr("<h1 align=center>The file index is still being built</h1>"));
+            else
+                message(tr("<h1 align=center>There's no file index</h1>Please configure the \"FileIndex\" directories."));
+            return false;
+        }
+        m_fileIndex->find(QProcess::splitCommand(command).mid(2)); // the list opens when it's done
+        return true;
+    }
     if (command.simplified().startsWith("type ")) {
         QStringList tokens = QProcess::splitCommand(command);
         if (tokens.count() < 2)
@@ -1891,16 +2487,9 @@ bool Qiq::runInput() {
             message(tr("<b>%1</b> is an alias for <i>%2</i>").arg(token).arg(alias));
             return true;
         }
-        if (m_bins->stringList().contains(token)) {
-            const QStringList paths = qEnvironmentVariable("PATH").split(':');
-            for (const QString &s : paths) {
-                QDir dir(s);
-                if (dir.entryList(QDir::Files|QDir::Executable).contains(token)) {
-                    message(tr("<b>%1</b> is <i>%2</i>").arg(token).arg(QFileInfo(dir, token).canonicalFilePath()));
-                    return true;
-                }
-            }
-        }
+        const QString path = m_binaries->path(token);
+        if (!path.isEmpty())
+            message(tr("<b>%1</b> is <i>%2</i>").arg(token).arg(QFileInfo(path).canonicalFilePath()));
         return true;
     }
     // custom command ===========================================================================================================
@@ -1989,6 +2578,7 @@ bool Qiq::runInput() {
     if (type != NoOut) {
         processDoneHandler = connect(process, &QProcess::finished, this, &Qiq::printOutput);
         process->setProperty("qiq_cmdline", m_input->text());
+        captureOutput(process);
     }
     if (type == Normal) { // NoOut is always detached and we want the output of everyhing else, no matter how long it takes and it doesn't need to survive us
         process->setChildProcessModifier([] {::setsid(); });
@@ -2000,6 +2590,7 @@ bool Qiq::runInput() {
                 process->closeReadChannel(QProcess::StandardError);
                 process->closeWriteChannel();
                 disconnect(processDoneHandler);
+                processOutputs.remove(process);
             }
             detachIO->deleteLater();
         });
@@ -2065,6 +2656,8 @@ bool Qiq::runInput() {
             if (type == ForceOut) {
                 process->setProperty("qiq_type", "stdout");
                 message("<h3 align=center>" + tr("Waiting for output…") + "</h3>");
+                if (QSharedPointer<ProcessOutput> output = processOutputs.value(process))
+                    output->stream = true;
             }
             const bool isSudo((exec == "sudo" || exec == "sudoedit") && !args.contains("-k")); // "sudo -k" fails w/ -n and never needs credentials
             if (isSudo) {
@@ -2090,6 +2683,8 @@ bool Qiq::runInput() {
                         args.replace(0, "-S"); //  -n has run it's course and would spoil -S
                         connect(process, &QProcess::finished, process, &QObject::deleteLater);
                         if (detachIO) detachIO->start(4000);
+                        if (processDoneHandler)
+                            captureOutput(process);
                         process->start(exec, args);
                         ret = process->waitForStarted(250);
                         if (ret) {
@@ -2122,6 +2717,18 @@ bool Qiq::runInput() {
                 m_currentHistoryIndex = HIST_SIZE + 1;
                 return true; // skip history saving
             }
+            // the files and dirs it was about, to jump there later on
+            for (QString arg : QProcess::splitCommand(m_input->text()).mid(1)) {
+                if (arg.startsWith('-'))
+                    continue;
+                if (arg.startsWith('~'))
+                    arg.replace(0,1,QDir::homePath());
+                const QFileInfo fileInfo(arg);
+                if (fileInfo.exists()) {
+                    m_frecency->visit(fileInfo.absoluteFilePath(), fileInfo.isDir());
+                    m_frecencySaver.start();
+                }
+            }
             m_history.prepend(m_input->text());
             if (m_history.size() > HIST_SIZE)
                 m_history.removeLast();
@@ -2145,9 +2752,9 @@ bool Qiq::runInput() {
     // last resort: is this some math?  ===========================================================================================
     if (!ret) {
         if (m_qalc.isNull()) {
-            if (m_bins->stringList().contains("qalc"))
+            if (m_binaries->contains("qalc"))
                 m_qalc = "qalc -f -";
-            else if (m_bins->stringList().contains("bc"))
+            else if (m_binaries->contains("bc"))
                 m_qalc = "bc -ilq";
         }
         if (!m_qalc.isEmpty()) {
@@ -2236,6 +2843,11 @@ void Qiq::toggle() {
     }
 }
 
+void Qiq::writeFrecency() {
+    if (!m_frecency->save(frecencyPath()))
+        qDebug() << "could not write" << frecencyPath();
+}
+
 void Qiq::writeHistory() {
     if (m_historyPath.isEmpty() || m_history.isEmpty()) // also don't try to save an empty history - who knows what happened there
         return;
@@ -25,27 +25,41 @@
 #include <QStackedWidget>
 #include <QTimer>
 
+class AppModel;
+class BinRegistry;
+class CmdCompleter;
+class CsvModel;
+class DirModel;
+class FileFinder;
+class FileIndex;
+class Frecency;
+class JsonModel;
 class Notifications;
+class OutputView;
 class QAbstractItemModel;
 class QDir;
-class QFileSystemModel;
 class QFileSystemWatcher;
 class QLabel;
 class QStandardItemModel;
 class QStringListModel;
 class QListView;
+class QProcess;
+class ResultModel;
 class QTextBrowser;
 class QTextEdit;
+class QTreeView;
 
 class Qiq : public QStackedWidget {
     Q_OBJECT
 public:
     Qiq(bool argb = false);
+    enum AppStuff { AppExec = Qt::UserRole + 1, AppComment, AppPath, AppNeedsTE, AppCategories, AppKeywords, MatchScore };
     QString ask(const QString &question, QLineEdit::EchoMode mode = QLineEdit::Normal);
     QString filterCustom(const QString source, const QString action = QString(), const QString fieldSeparator = QString());
     void reconfigure();
     static int msFromString(const QString &string);
     void toggle();
+    void writeFrecency();
     void writeHistory();
     void writeTodoList();
 protected:
@@ -53,13 +67,15 @@ protected:
     void enterEvent(QEnterEvent *ee) override;
     bool eventFilter(QObject *o, QEvent *e) override;
 private:
-    enum MatchType { Begin = 0, Partial };
-    enum AppStuff { AppExec = Qt::UserRole + 1, AppComment, AppPath, AppNeedsTE, AppCategories, AppKeywords, MatchScore };
+    enum MatchType { Begin = 0, Partial, Fuzzy };
     void adjustGeometry(bool now = false);
+    void captureOutput(QProcess *process);
     void completeDir(const QDir &cdir, bool force, const QString filter = QString());
     void explicitlyComplete();
-    void filter(const QString needle, MatchType matchType);
+    void filter(const QString needle, MatchType matchType, bool background = false);
     void filterInput();
+    void findFiles();
+    bool gatherHaystack(); // false if the list is just scanned
     bool insertToken(bool selectDiff);
     void makeApplicationModel();
     void message(const QString &string);
@@ -69,26 +85,43 @@ private:
     void setModel(QAbstractItemModel *model);
     void setOffset(QPoint offset);
     void setPwd(QString path);
+    void showMatches(const QString &needle, MatchType matched, bool shrink, const QList<int> &matches, const QList<int> &scores);
+    void streamOutput(QProcess *process);
     void tokenUnderCursor(int &left, int &right);
     void updateBinaries();
     void updateTodoTimers();
     QListView *m_list;
+    ResultModel *m_results;
     QTextBrowser *m_disp;
+    OutputView *m_view;
+    QTreeView *m_tree;
+    JsonModel *m_json;
+    CsvModel *m_csv;
     QLineEdit *m_input;
     QWidget *m_status;
-    QStandardItemModel *m_applications, *m_external;
+    AppModel *m_applications;
+    QStandardItemModel *m_external, *m_found;
     QStringListModel *m_bins, *m_cmdHistory, *m_cmdCompleted;
-    QFileSystemModel *m_files;
+    BinRegistry *m_binaries;
+    DirModel *m_files;
+    FileFinder *m_finder;
+    FileIndex *m_fileIndex;
     QSize m_defaultSize;
     int m_lastVisibleRow;
     QString m_externCmd, m_externalReply;
     bool m_wasVisble;
     QHash<QString,QString> m_aliases;
-    QString m_aha, m_qalc, m_term, m_cmdCompletion, m_cmdCompletionSep;
+    QString m_qalc, m_term, m_cmdCompletionSep;
+    CmdCompleter *m_cmdCompleter;
     QStringList m_history, m_histIgnore;
     int m_currentHistoryIndex;
     QString m_inputBuffer, m_lastCommand;
+    qint64 m_outputLimit;
+    bool m_outputTail;
+    bool m_structuredOutput;
     QTimer m_autoHide;
+    Frecency *m_frecency;
+    QTimer m_frecencySaver;
     QTimer *m_historySaver;
     QString m_historyPath;
     Notifications *m_notifications;
@@ -99,6 +132,7 @@ private:
     QTimer *m_todoSaver;
     int m_iconSize;
     bool m_selectionIsSynthetic;
+    bool m_fuzzy;
     bool m_grabKeyboard;
     bool m_askingQuestion;
     QFileSystemWatcher *m_inotify;
@@ -1,6 +1,6 @@
-HEADERS = qiq.h gauge.h notifications.h
-SOURCES = main.cpp qiq.cpp gauge.cpp notifications.cpp
-QT      += dbus gui widgets
+HEADERS = qiq.h ansiconverter.h applications.h binregistry.h cmdcompleter.h csvmodel.h dirmodel.h filefinder.h fileindex.h frecency.h fuzzymatcher.h gauge.h iconloader.h jsonmodel.h notifications.h outputbuffer.h outputview.h resultmodel.h searchtable.h trigramindex.h
+SOURCES = main.cpp qiq.cpp ansiconverter.cpp applications.cpp binregistry.cpp cmdcompleter.cpp csvmodel.cpp dirmodel.cpp filefinder.cpp fileindex.cpp frecency.cpp fuzzymatcher.cpp gauge.cpp iconloader.cpp jsonmodel.cpp notifications.cpp outputbuffer.cpp outputview.cpp resultmodel.cpp searchtable.cpp trigramindex.cpp
+QT      += concurrent dbus gui widgets
 unix:!macx:LIBS    += -lLayerShellQtInterface
 #lessThan(QT_MAJOR_VERSION, 6){
 #  unix:!macx:QT += x11extras
@@ -0,0 +1,277 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <algorithm>
+#include <climits>
+
+#include "qiq.h"
+#include "resultmodel.h"
+
+#define RANK_BATCH 128 // a few screens worth
+
+static inline quint64 matchKey(int row, int score) {
+    return (quint64(quint32(INT_MAX - score)) << 32) | quint32(row);
+}
+static inline int matchRow(quint64 key) {
+    return int(key & 0xffffffff);
+}
+static inline int matchScore(quint64 key) {
+    return INT_MAX - int(key >> 32);
+}
+
+ResultModel::ResultModel(QObject *parent) : QAbstractProxyModel(parent), m_ranked(0), m_filtered(false) {
+}
+
+bool ResultModel::canFetchMore(const QModelIndex &parent) const {
+    if (parent.isValid() || !sourceModel())
+        return false;
+    if (m_filtered && m_ranked < m_matches.size())
+        return true;
+    return sourceModel()->canFetchMore(m_root);
+}
+
+int ResultModel::columnCount(const QModelIndex &parent) const {
+    return (parent.isValid() || !sourceModel()) ? 0 : 1;
+}
+
+QVariant ResultModel::data(const QModelIndex &index, int role) const {
+    if (role == Qiq::MatchScore && m_filtered && index.isValid())
+        return index.row() < m_ranked ? matchScore(m_matches.at(index.row())) : 0;
+    return QAbstractProxyModel::data(index, role);
+}
+
+void ResultModel::fetchMore(const QModelIndex &parent) {
+    if (parent.isValid() || !sourceModel())
+        return;
+    if (m_filtered && m_ranked < m_matches.size()) {
+        const int count = qMin(RANK_BATCH, int(m_matches.size()) - m_ranked);
+        beginInsertRows(QModelIndex(), m_ranked, m_ranked + count - 1);
+        rank(count);
+        endInsertRows();
+        return;
+    }
+    sourceModel()->fetchMore(m_root);
+}
+
+bool ResultModel::hasChildren(const QModelIndex &parent) const {
+    return !parent.isValid() && rowCount() > 0;
+}
+
+QModelIndex ResultModel::index(int row, int column, const QModelIndex &parent) const {
+    if (parent.isValid() || row < 0 || column < 0 || row >= rowCount() || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex ResultModel::mapFromSource(const QModelIndex &sourceIndex) const {
+    if (!sourceIndex.isValid() || sourceIndex.column() != 0 || m_root != sourceIndex.parent())
+        return QModelIndex();
+    if (!m_filtered)
+        return index(sourceIndex.row(), 0);
+    for (int i = 0; i < m_ranked; ++i) {
+        if (matchRow(m_matches.at(i)) == sourceIndex.row())
+            return index(i, 0);
+    }
+    return QModelIndex();
+}
+
+QModelIndex ResultModel::mapToSource(const QModelIndex &proxyIndex) const {
+    if (!proxyIndex.isValid() || !sourceModel() || proxyIndex.row() >= rowCount())
+        return QModelIndex();
+    return sourceModel()->index(m_filtered ? matchRow(m_matches.at(proxyIndex.row())) : proxyIndex.row(), proxyIndex.column(), m_root);
+}
+
+QModelIndex ResultModel::parent(const QModelIndex &) const {
+    return QModelIndex();
+}
+
+void ResultModel::rank(int count) {
+    // heap select, O(n log k) for the next k instead of sorting all matches
+    const auto begin = m_matches.begin() + m_ranked;
+    std::partial_sort(begin, begin + count, m_matches.end());
+    m_ranked += count;
+}
+
+int ResultModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid() || !sourceModel())
+        return 0;
+    return m_filtered ? m_ranked : sourceModel()->rowCount(m_root);
+}
+
+void ResultModel::setRoot(const QModelIndex &sourceRoot) {
+    beginResetModel();
+    m_root = sourceRoot;
+    m_filtered = false;
+    m_matches.clear();
+    m_ranked = 0;
+    endResetModel();
+}
+
+void ResultModel::setRows(const QList<int> &rows, const QList<int> &scores) {
+    beginResetModel();
+    m_filtered = true;
+    m_matches.resize(rows.size());
+    for (int i = 0; i < rows.size(); ++i)
+        m_matches[i] = matchKey(rows.at(i), i < scores.size() ? scores.at(i) : 0);
+    m_ranked = 0;
+    if (scores.isEmpty()) // source order, nothing to rank
+        m_ranked = m_matches.size();
+    else
+        rank(qMin(RANK_BATCH, int(m_matches.size())));
+    endResetModel();
+}
+
+void ResultModel::setSourceModel(QAbstractItemModel *model) {
+    if (model == sourceModel())
+        return;
+    beginResetModel();
+    if (sourceModel())
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    QAbstractProxyModel::setSourceModel(model);
+    m_root = QModelIndex();
+    m_filtered = false;
+    m_matches.clear();
+    m_ranked = 0;
+    if (model) {
+        connect(model, &QAbstractItemModel::modelAboutToBeReset, this, [=]() { beginResetModel(); });
+        connect(model, &QAbstractItemModel::modelReset, this, [=]() {
+            m_filtered = false;
+            m_matches.clear();
+            m_ranked = 0;
+            endResetModel();
+        });
+        connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this, [=](const QModelIndex &parent, int first, int last) {
+            if (!m_filtered && m_root == parent)
+                beginInsertRows(QModelIndex(), first, last);
+        });
+        connect(model, &QAbstractItemModel::rowsInserted, this, [=](const QModelIndex &parent, int first, int last) {
+            if (m_root != parent)
+                return;
+            if (!m_filtered) {
+                endInsertRows();
+                return;
+            }
+            // new rows didn't get to match anything, only shift the old ones
+            // (same offset for all rows, so the order holds)
+            for (quint64 &key : m_matches)
+                if (matchRow(key) >= first)
+                    key += last - first + 1;
+        });
+        connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &ResultModel::sourceRowsAboutToBeRemoved);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, [=](const QModelIndex &parent, int first, int last) {
+            if (m_root != parent)
+                return;
+            if (!m_filtered) {
+                endRemoveRows();
+                return;
+            }
+            for (quint64 &key : m_matches)
+                if (matchRow(key) > last)
+                    key -= last - first + 1;
+        });
+        connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this, &ResultModel::sourceLayoutAboutToBeChanged);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &ResultModel::sourceLayoutChanged);
+        connect(model, &QAbstractItemModel::rowsAboutToBeMoved, this, &ResultModel::sourceLayoutAboutToBeChanged);
+        connect(model, &QAbstractItemModel::rowsMoved, this, &ResultModel::sourceLayoutChanged);
+        connect(model, &QAbstractItemModel::dataChanged, this, [=](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+            if (m_root != topLeft.parent() || !rowCount())
+                return;
+            // scattered rows, the views only repaint what's visible anyway
+            if (m_filtered)
+                emit dataChanged(index(0, 0), index(rowCount() - 1, 0), roles);
+            else
+                emit dataChanged(index(topLeft.row(), 0), index(bottomRight.row(), 0), roles);
+        });
+    }
+    endResetModel();
+}
+
+void ResultModel::showAll() {
+    setRoot(m_root);
+}
+
+QList<int> ResultModel::sourceRows() const {
+    QList<int> rows(m_matches.size());
+    for (int i = 0; i < m_matches.size(); ++i)
+        rows[i] = matchRow(m_matches.at(i));
+    return rows;
+}
+
+void ResultModel::sourceLayoutAboutToBeChanged() {
+    emit layoutAboutToBeChanged();
+    m_layoutProxies = persistentIndexList();
+    m_layoutSources.clear();
+    for (const QModelIndex &idx : m_layoutProxies)
+        m_layoutSources << mapToSource(idx);
+    m_layoutRows.clear();
+    if (m_filtered) {
+        m_layoutRows.reserve(m_matches.size());
+        for (quint64 key : m_matches)
+            m_layoutRows << sourceModel()->index(matchRow(key), 0, m_root);
+    }
+}
+
+void ResultModel::sourceLayoutChanged() {
+    if (m_filtered) {
+        QList<quint64> matches;
+        matches.reserve(m_layoutRows.size());
+        int ranked = 0;
+        for (int i = 0; i < m_layoutRows.size(); ++i) {
+            if (!m_layoutRows.at(i).isValid() || m_root != m_layoutRows.at(i).parent())
+                continue;
+            matches << matchKey(m_layoutRows.at(i).row(), matchScore(m_matches.at(i)));
+            if (i < m_ranked)
+                ++ranked;
+        }
+        m_matches = matches;
+        m_ranked = ranked;
+    }
+    QModelIndexList proxies;
+    for (const QPersistentModelIndex &idx : m_layoutSources)
+        proxies << mapFromSource(idx);
+    changePersistentIndexList(m_layoutProxies, proxies);
+    m_layoutRows.clear();
+    m_layoutSources.clear();
+    m_layoutProxies.clear();
+    emit layoutChanged();
+}
+
+void ResultModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last) {
+    if (m_root != parent)
+        return;
+    if (!m_filtered) {
+        beginRemoveRows(QModelIndex(), first, last);
+        return;
+    }
+    auto removed = [=](quint64 key) { return matchRow(key) >= first && matchRow(key) <= last; };
+    // the unranked ones aren't shown, just drop them
+    m_matches.erase(std::remove_if(m_matches.begin() + m_ranked, m_matches.end(), removed), m_matches.end());
+    // the ranked ones back to front in contiguous runs
+    for (int i = m_ranked - 1; i >= 0; --i) {
+        if (!removed(m_matches.at(i)))
+            continue;
+        int j = i;
+        while (j > 0 && removed(m_matches.at(j - 1)))
+            --j;
+        beginRemoveRows(QModelIndex(), j, i);
+        m_matches.remove(j, i - j + 1);
+        m_ranked -= i - j + 1;
+        endRemoveRows();
+        i = j;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef RESULTMODEL_H
+#define RESULTMODEL_H
+
+#include <QAbstractProxyModel>
+
+// Flat proxy over the children of one source root which exposes only the matching rows,
+// in ranked order if there's a score. The source model is never hidden or reordered.
+// Until setRows() it just passes every row through.
+// Ranking is lazy, only the top batch is sorted and fetchMore() ranks the next one.
+class ResultModel : public QAbstractProxyModel {
+    Q_OBJECT
+public:
+    ResultModel(QObject *parent = nullptr);
+    bool canFetchMore(const QModelIndex &parent) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    bool isFiltered() const { return m_filtered; }
+    int matchCount() const { return m_filtered ? m_matches.size() : rowCount(); }
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    QModelIndex root() const { return m_root; }
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    void setRoot(const QModelIndex &sourceRoot);
+    void setRows(const QList<int> &rows, const QList<int> &scores = QList<int>());
+    void setSourceModel(QAbstractItemModel *model) override;
+    void showAll();
+    QList<int> sourceRows() const; // all matches, ranked or not - only if isFiltered()
+private:
+    void rank(int count);
+    void sourceLayoutAboutToBeChanged();
+    void sourceLayoutChanged();
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    QPersistentModelIndex m_root;
+    // inverted score in the upper, source row in the lower half, so ascending is best first
+    // [0, m_ranked) is sorted, the rest is whatever order
+    QList<quint64> m_matches;
+    int m_ranked;
+    bool m_filtered;
+    // to follow the rows through source layout changes
+    QList<QPersistentModelIndex> m_layoutRows, m_layoutSources;
+    QModelIndexList m_layoutProxies;
+};
+
+#endif // RESULTMODEL_H
@@ -0,0 +1,64 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "searchtable.h"
+
+SearchTable::SearchTable(int fields) {
+    m_columns.resize(qMax(1, fields));
+    clear();
+}
+
+void SearchTable::append(int field, QStringView text) {
+    Column &column = m_columns[field];
+    column.keys += fold(text);
+    column.offsets << column.keys.size();
+}
+
+void SearchTable::clear() {
+    for (Column &column : m_columns) {
+        column.keys.clear();
+        column.offsets = QList<quint32>() << 0;
+    }
+}
+
+QStringView SearchTable::key(int row, int field) const {
+    const Column &column = m_columns.at(field);
+    const quint32 start = column.offsets.at(row);
+    return QStringView(column.keys).sliced(start, column.offsets.at(row + 1) - start);
+}
+
+void SearchTable::reserve(int rows) {
+    for (Column &column : m_columns)
+        column.offsets.reserve(rows + 1);
+}
+
+QString SearchTable::fold(QStringView string) {
+    bool ascii = true;
+    for (const QChar c : string) {
+        if (c.unicode() > 0x7f) {
+            ascii = false;
+            break;
+        }
+    }
+    if (ascii)
+        return string.toString().toLower();
+    // decompose "é" into "e" + combining accent and drop the latter, KD also turns "ﬁ" into "fi"
+    QString folded = string.toString().normalized(QString::NormalizationForm_KD);
+    folded.removeIf([](QChar c) { return c.category() == QChar::Mark_NonSpacing; });
+    return folded.toCaseFolded();
+}
@@ -0,0 +1,44 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef SEARCHTABLE_H
+#define SEARCHTABLE_H
+
+#include <QList>
+#include <QString>
+
+// Case and diacritic folded search keys, one contiguous string per field plus the row offsets
+// Needles have to be fold()ed as well, matching is then a plain case sensitive search
+class SearchTable {
+public:
+    SearchTable(int fields = 1);
+    void append(int field, QStringView text);
+    void clear();
+    int count() const { return m_columns.at(0).offsets.size() - 1; }
+    QStringView key(int row, int field = 0) const;
+    void reserve(int rows);
+    static QString fold(QStringView string);
+private:
+    struct Column {
+        QString keys;
+        QList<quint32> offsets;
+    };
+    QList<Column> m_columns;
+};
+
+#endif // SEARCHTABLE_H
@@ -0,0 +1,124 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+// AnsiConverter throughput on a generated colored log, and the external converter it replaced
+// usage: ansi [MiB] [aha command]
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include "ansiconverter.h"
+
+#define SIZE 64 // MiB of colored output
+#define CHUNK (1<<16) // what a process typically delivers at once
+#define INSERT_SIZE (4<<20) // the text document is slow enough with less
+
+static const char *gs_words[] = { "accepted", "connection", "from", "user", "session", "opened", "closed", "refused",
+                                  "timeout", "error", "warning", "kernel", "usb", "device", "mounted", "network" };
+
+// a bit of everything, like compilers, ls, systemctl and progress bars do it
+static QByteArray coloredLog(qsizetype size) {
+    QRandomGenerator random(4711);
+    QByteArray data;
+    data.reserve(size + 256);
+    while (data.size() < size) {
+        const int words = 4 + random.bounded(8);
+        for (int w = 0; w < words; ++w) {
+            switch (random.bounded(8)) {
+                case 0: data += "\e[1;3" + QByteArray::number(random.bounded(8)) + "m"; break;
+                case 1: data += "\e[38;5;" + QByteArray::number(random.bounded(256)) + "m"; break;
+                case 2: data += "\e[38;2;" + QByteArray::number(random.bounded(256)) + ';' + QByteArray::number(random.bounded(256)) + ';' + QByteArray::number(random.bounded(256)) + "m"; break;
+                case 3: data += "\e[4m"; break;
+                case 4: data += "\e[0m"; break;
+                case 5: data += "\e[K"; break; // cursor stuff, dropped
+                default: break; // plain
+            }
+            data += gs_words[random.bounded(int(sizeof(gs_words)/sizeof(gs_words[0])))];
+            data += ' ';
+        }
+        data += "<&>\e[0m\n"; // needs escaping in html
+    }
+    return data;
+}
+
+template <typename Convert> static void measure(const char *what, const QByteArray &data, Convert convert) {
+    QElapsedTimer timer;
+    timer.start();
+    qsizetype out = 0;
+    for (qsizetype i = 0; i < data.size(); i += CHUNK)
+        out += convert(QByteArray::fromRawData(data.constData() + i, qMin(qsizetype(CHUNK), data.size() - i)));
+    const double secs = timer.nsecsElapsed()/1e9;
+    printf("%-24s %8.1f MiB/s %10.2f ms %12lld chars out\n", what, data.size()/secs/(1<<20), secs*1e3, (long long)out);
+}
+
+int main(int argc, char **argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen"); // the text document wants fonts, but no display
+    QGuiApplication app(argc, argv);
+    const qsizetype size = qsizetype(argc > 1 ? atoi(argv[1]) : SIZE) << 20;
+    QString aha = argc > 2 ? QString::fromLocal8Bit(argv[2]) : QString();
+    if (aha.isEmpty()) { // the same defaults printOutput() had
+        if (!QStandardPaths::findExecutable("ansifilter").isEmpty())
+            aha = "ansifilter -f -H";
+        else if (!QStandardPaths::findExecutable("aha").isEmpty())
+            aha = "aha -x -n";
+    }
+    const QByteArray data = coloredLog(size);
+    printf("%lld bytes in chunks of %d\n", (long long)data.size(), CHUNK);
+
+    AnsiConverter converter;
+    measure("toHtml", data, [&](const QByteArray &chunk) { return converter.toHtml(chunk).size(); });
+    QList<QTextLayout::FormatRange> formats;
+    measure("toText", data, [&](const QByteArray &chunk) { return converter.toText(chunk, formats).size(); });
+    measure("track", data, [&](const QByteArray &chunk) { converter.track(chunk); return 0; });
+    QTextDocument document;
+    QTextCursor cursor(&document);
+    measure("insert, first 4 MiB", data.left(INSERT_SIZE), [&](const QByteArray &chunk) {
+        converter.insert(cursor, chunk);
+        return chunk.size();
+    });
+
+    if (aha.isEmpty()) {
+        printf("neither ansifilter nor aha found, pass a command to compare\n");
+        return 0;
+    }
+    // all at once, printOutput() gave it 250 ms so this only ever worked for small outputs
+    QElapsedTimer timer;
+    timer.start();
+    QProcess process;
+    process.startCommand(aha);
+    if (!process.waitForStarted()) {
+        printf("%s did not start\n", qPrintable(aha));
+        return 1;
+    }
+    qsizetype out = 0;
+    QObject::connect(&process, &QProcess::readyReadStandardOutput, [&]() { out += process.readAllStandardOutput().size(); });
+    process.write(data);
+    process.closeWriteChannel();
+    process.waitForFinished(-1);
+    out += process.readAllStandardOutput().size();
+    const double secs = timer.nsecsElapsed()/1e9;
+    printf("%-24s %8.1f MiB/s %10.2f ms %12lld bytes out\n", qPrintable(aha), data.size()/secs/(1<<20), secs*1e3, (long long)out);
+    return 0;
+}
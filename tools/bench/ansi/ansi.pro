@@ -0,0 +1,6 @@
+HEADERS = ../../ansiconverter.h
+SOURCES = ansi.cpp ../../ansiconverter.cpp
+INCLUDEPATH += ../..
+QT      += gui
+CONFIG  += console
+TARGET  = ansi
@@ -0,0 +1,207 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+// Loads 5k synthetic desktop entries through the old QSettings INI cache and through the mapped AppIndex
+// usage: appindex [entries] [runs]
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QIcon>
+#include <QPixmap>
+#include <QSet>
+#include <QSettings>
+#include <QStandardItemModel>
+#include <QTemporaryDir>
+
+#include <climits>
+
+#include "applications.h"
+#include "qiq.h"
+
+#define ENTRIES 5000 // synthetic desktop files
+#define RUNS 5 // the fastest one is reported
+#define LOCALE "de_DE"
+
+static const char *gs_languages[] = { "ar", "cs", "de", "de_DE", "es", "fr", "it", "ja", "nl", "pl", "pt_BR", "ru", "sv", "uk", "zh_CN" };
+
+template <typename Run> static qint64 fastest(int runs, Run run) {
+    qint64 best = LLONG_MAX;
+    for (int i = 0; i < runs; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        run(i);
+        best = qMin(best, timer.nsecsElapsed());
+    }
+    return best;
+}
+
+static void report(const char *what, qint64 nsecs) {
+    printf("%-40s %10.2f ms\n", what, nsecs/1e6);
+}
+
+// translations are what makes real desktop files big, so they get a bunch
+static void writeEntries(const QString &dir, int count) {
+    for (int i = 0; i < count; ++i) {
+        const QByteArray n = QByteArray::number(i);
+        QByteArray data = "[Desktop Entry]\nType=Application\nName=Bench Application " + n + "\n";
+        for (const char *lang : gs_languages)
+            data += QByteArray("Name[") + lang + "]=Bench Application " + n + " (" + lang + ")\n";
+        data += "Comment=Does synthetic things number " + n + "\n";
+        for (const char *lang : gs_languages)
+            data += QByteArray("Comment[") + lang + "]=Does synthetic things number " + n + " (" + lang + ")\n";
+        data += "Keywords=bench;synthetic;" + n + ";\n";
+        for (const char *lang : gs_languages)
+            data += QByteArray("Keywords[") + lang + "]=bench;synthetic;" + lang + ";\n";
+        data += "Exec=bench-app-" + n + " %U\n";
+        data += "Icon=bench-icon-" + QByteArray::number(i % 100) + "\n";
+        data += QByteArray("Terminal=") + (i % 10 ? "false" : "true") + "\n";
+        data += "Categories=Utility;Development;\n";
+        data += "\n[Desktop Action new-window]\nName=New Window\nExec=bench-app-" + n + " --new-window\n";
+        QFile file(dir + QString("/bench-%1.desktop").arg(i));
+        if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size())
+            qFatal("cannot write %s", qPrintable(file.fileName()));
+    }
+}
+
+// what makeApplicationModel() did before the index
+static void oldReindex(const QStringList &paths, const QString &cachePath, QStandardItemModel *model) {
+    const QString de_DE = LOCALE;
+    const QString de = de_DE.split('_').first();
+    model->clear();
+    QSettings cache(cachePath, QSettings::IniFormat);
+    cache.clear();
+    QPixmap dummyPix(32, 32);
+    dummyPix.fill(Qt::transparent);
+    QIcon dummyIcon(dummyPix);
+    QSet<QString> augmented;
+    for (const QString &path : paths) {
+        const QStringList files = QDir(path).entryList(QStringList() << "*.desktop", QDir::Files|QDir::Readable);
+        for (const QString &file : files) {
+            if (augmented.contains(file))
+                continue;
+            augmented.insert(file);
+            QSettings service(path + QDir::separator() + file, QSettings::IniFormat);
+            service.beginGroup("Desktop Entry");
+            if (service.value("Type").toString() != "Application")
+                continue;
+            auto localized = [&](const QString &key) {
+                QString v = service.value(key + "[" + de_DE + "]").toString();
+                if (v.isEmpty())
+                    v = service.value(key + "[" + de + "]").toString();
+                if (v.isEmpty())
+                    v = service.value(key).toString();
+                return v;
+            };
+            const QString name = localized("Name");
+            const QString exec = service.value("Exec").toString();
+            if (name.isEmpty() || exec.isEmpty())
+                continue;
+            cache.beginGroup(file);
+            cache.setValue("Name", name);
+            cache.setValue("Exec", exec);
+            const QString icon = service.value("Icon").toString();
+            if (!icon.isEmpty())
+                cache.setValue("Icon", icon);
+            QStandardItem *item = new QStandardItem(QIcon::fromTheme(icon, dummyIcon), name);
+            item->setData(exec, Qiq::AppExec);
+            const QString comment = localized("Comment");
+            if (!comment.isEmpty())
+                cache.setValue("Comment", comment);
+            item->setData(comment, Qiq::AppComment);
+            const bool terminal = service.value("Terminal", false).toBool();
+            cache.setValue("Terminal", terminal);
+            item->setData(terminal, Qiq::AppNeedsTE);
+            const QString cats = service.value("Categories").toString();
+            if (!cats.isEmpty())
+                cache.setValue("Categories", cats);
+            item->setData(cats.split(';'), Qiq::AppCategories);
+            const QString keywords = localized("Keywords");
+            if (!keywords.isEmpty())
+                cache.setValue("Keywords", keywords);
+            item->setData(keywords.split(';'), Qiq::AppKeywords);
+            cache.endGroup();
+            model->appendRow(item);
+        }
+    }
+    cache.sync();
+}
+
+// the old cached start
+static void oldLoad(const QString &cachePath, QStandardItemModel *model) {
+    model->clear();
+    QSettings cache(cachePath, QSettings::IniFormat);
+    QPixmap dummyPix(32, 32);
+    dummyPix.fill(Qt::transparent);
+    QIcon dummyIcon(dummyPix);
+    for (const QString &entry : cache.childGroups()) {
+        cache.beginGroup(entry);
+        QStandardItem *item = new QStandardItem(QIcon::fromTheme(cache.value("Icon").toString(), dummyIcon), cache.value("Name").toString());
+        item->setData(cache.value("Exec").toString(), Qiq::AppExec);
+        item->setData(cache.value("Comment").toString(), Qiq::AppComment);
+        item->setData(cache.value("Path"), Qiq::AppPath);
+        item->setData(cache.value("Terminal", false).toBool(), Qiq::AppNeedsTE);
+        item->setData(cache.value("Categories").toString().split(';'), Qiq::AppCategories);
+        item->setData(cache.value("Keywords").toString().split(';'), Qiq::AppKeywords);
+        model->appendRow(item);
+        cache.endGroup();
+    }
+}
+
+int main(int argc, char **argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen"); // icons need a gui app, but not a display
+    QGuiApplication app(argc, argv);
+    const int entries = argc > 1 ? atoi(argv[1]) : ENTRIES;
+    const int runs = argc > 2 ? atoi(argv[2]) : RUNS;
+    QTemporaryDir tmp;
+    if (!tmp.isValid() || !QDir(tmp.path()).mkdir("applications"))
+        qFatal("no temporary directory");
+    const QStringList paths(tmp.filePath("applications"));
+    writeEntries(paths.first(), entries);
+    printf("%d desktop entries, fastest of %d runs\n", entries, runs);
+
+    // QSettings keeps parsed files around per process, so every run gets its own copy of the cache
+    QStandardItemModel model;
+    const QString cachePath = tmp.filePath("apps.cache");
+    report("QSettings: reindex", fastest(runs, [&](int) { oldReindex(paths, cachePath, &model); }));
+    for (int i = 0; i < runs; ++i)
+        QFile::copy(cachePath, tmp.filePath(QString("apps.%1.cache").arg(i)));
+    report("QSettings: load cache", fastest(runs, [&](int i) { oldLoad(tmp.filePath(QString("apps.%1.cache").arg(i)), &model); }));
+    if (model.rowCount() != entries)
+        qWarning("QSettings cache has %d entries", model.rowCount());
+
+    const QString indexPath = tmp.filePath("apps.index");
+    report("AppIndex: reindex", fastest(runs, [&](int) { QFile::remove(indexPath); AppIndex::update(nullptr, paths, indexPath, LOCALE); }));
+    QSharedPointer<AppIndex> index(new AppIndex);
+    index->load(indexPath);
+    report("AppIndex: update, nothing changed", fastest(runs, [&](int) { AppIndex::update(index, paths, indexPath, LOCALE); }));
+    report("AppIndex: load", fastest(runs, [&](int) { index.reset(new AppIndex); index->load(indexPath); }));
+    AppModel appModel;
+    appModel.setIconSize(32);
+    report("AppIndex: load + model", fastest(runs, [&](int) {
+        index.reset(new AppIndex);
+        index->load(indexPath);
+        appModel.setIndex(index);
+    }));
+    if (appModel.rowCount() != entries)
+        qWarning("AppIndex has %d entries", appModel.rowCount());
+    return 0;
+}
@@ -0,0 +1,6 @@
+HEADERS = ../../applications.h ../../iconloader.h
+SOURCES = appindex.cpp ../../applications.cpp ../../fuzzymatcher.cpp ../../iconloader.cpp ../../searchtable.cpp
+INCLUDEPATH += ../..
+QT      += concurrent dbus gui widgets
+CONFIG  += console
+TARGET  = appindex
@@ -0,0 +1,4 @@
+# standalone benchmarks, not part of the qiq build
+# cd tools/bench && qmake6 && make, then run e.g. ./appindex/appindex
+TEMPLATE = subdirs
+SUBDIRS = ansi appindex completion trigram
@@ -0,0 +1,86 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+// Completion latency, a zsh per request (as before) vs. the persistent server
+// usage: completion [command] [rounds]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+
+#include <algorithm>
+
+#include "cmdcompleter.h"
+
+#define COMMAND SOURCE_DIR "/doc/zsh-autocomplete"
+#define ROUNDS 10 // over all lines
+
+static const char *gs_lines[] = { "ls --co", "cd /u", "kill -", "grep --i", "tar -" };
+
+// until the completer is done, with an empty cache so zsh is asked every time
+static qint64 complete(CmdCompleter &completer, const QString &line, int &count) {
+    QEventLoop loop;
+    count = 0;
+    QObject::connect(&completer, &CmdCompleter::completed, &loop, [&](const QStringList &completions, bool done) {
+        count += completions.size();
+        if (done)
+            loop.quit();
+    });
+    completer.clearCache();
+    QElapsedTimer timer;
+    timer.start();
+    completer.request(line);
+    if (completer.isPending())
+        loop.exec();
+    return timer.nsecsElapsed();
+}
+
+static void report(const char *what, QList<qint64> times, int count) {
+    if (times.isEmpty())
+        return;
+    std::sort(times.begin(), times.end());
+    printf("%-28s %8.2f ms median %8.2f ms min %8.2f ms max %6d completions\n", what,
+           times.at(times.size()/2)/1e6, times.first()/1e6, times.last()/1e6, count);
+}
+
+static void measure(const QString &command, bool persistent, int rounds) {
+    CmdCompleter completer;
+    completer.setCommand(command, persistent);
+    int count, total = 0;
+    if (persistent) // the first answer waits for the shell and compinit
+        report("server, first request", QList<qint64>() << complete(completer, gs_lines[0], count), count);
+    QList<qint64> times;
+    for (int r = 0; r < rounds; ++r) {
+        for (const char *line : gs_lines) {
+            times << complete(completer, line, count);
+            total += count;
+        }
+    }
+    report(persistent ? "server" : "process per request", times, total);
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    const QString command = argc > 1 ? QString::fromLocal8Bit(argv[1]) : QString(COMMAND);
+    const int rounds = argc > 2 ? atoi(argv[2]) : ROUNDS;
+    printf("%s, %d rounds over %d lines\n", qPrintable(command), rounds, int(sizeof(gs_lines)/sizeof(gs_lines[0])));
+    measure(command, false, rounds);
+    measure(command, true, rounds);
+    return 0;
+}
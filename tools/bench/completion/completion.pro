@@ -0,0 +1,7 @@
+HEADERS = ../../cmdcompleter.h
+SOURCES = completion.cpp ../../cmdcompleter.cpp
+INCLUDEPATH += ../..
+DEFINES += SOURCE_DIR=\\\"$$PWD/../..\\\"
+QT      -= gui
+CONFIG  += console
+TARGET  = completion
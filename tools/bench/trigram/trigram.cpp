@@ -0,0 +1,110 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+// Filters 1M synthetic log lines like filter() does, linear vs. through the TrigramIndex
+// usage: trigram [lines] [runs]
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringList>
+
+#include <climits>
+
+#include "trigramindex.h"
+
+#define LINES 1000000 // synthetic log lines
+#define RUNS 5 // the fastest one is reported
+
+static const char *gs_words[] = { "accepted", "connection", "from", "user", "session", "opened", "closed", "refused",
+                                  "timeout", "error", "warning", "kernel", "usb", "device", "mounted", "network",
+                                  "interface", "link", "up", "down", "started", "stopped", "service", "failed" };
+
+template <typename Run> static qint64 fastest(int runs, Run run) {
+    qint64 best = LLONG_MAX;
+    for (int i = 0; i < runs; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        run();
+        best = qMin(best, timer.nsecsElapsed());
+    }
+    return best;
+}
+
+// what filter() does to every row for a partial match
+static bool matches(const QString &text, const QStringList &tokens) {
+    for (const QString &token : tokens) {
+        if (!text.contains(token, Qt::CaseInsensitive))
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const int lines = argc > 1 ? atoi(argv[1]) : LINES;
+    const int runs = argc > 2 ? atoi(argv[2]) : RUNS;
+    QRandomGenerator random(4711); // the same lines every time
+    QStringList texts;
+    texts.reserve(lines);
+    for (int i = 0; i < lines; ++i) {
+        QString line = QString("Oct 16 %1:%2:%3 host%4 ").arg(random.bounded(24), 2, 10, QChar('0'))
+                                                          .arg(random.bounded(60), 2, 10, QChar('0'))
+                                                          .arg(random.bounded(60), 2, 10, QChar('0'))
+                                                          .arg(random.bounded(16));
+        const int words = 4 + random.bounded(8);
+        for (int w = 0; w < words; ++w)
+            line += QString::fromLatin1(gs_words[random.bounded(int(sizeof(gs_words)/sizeof(gs_words[0])))]) + ' ';
+        line += "pid=" + QString::number(random.bounded(100000));
+        texts << line;
+    }
+    printf("%d lines, fastest of %d runs\n", lines, runs);
+
+    TrigramIndex index;
+    QElapsedTimer timer;
+    timer.start();
+    for (const QString &text : texts)
+        index.append(text);
+    printf("%-30s %10.2f ms\n", "build index", timer.nsecsElapsed()/1e6);
+
+    const QStringList needles = { "error", "Connection Refused", "pid=4711", "usb mounted failed", "zzz", "up" };
+    printf("%-30s %10s %10s %10s\n", "needle", "matches", "linear", "index");
+    for (const QString &needle : needles) {
+        const QStringList tokens = needle.split(' ', Qt::SkipEmptyParts);
+        int linearCount = 0, indexCount = 0;
+        const qint64 linear = fastest(runs, [&]() {
+            linearCount = 0;
+            for (const QString &text : texts)
+                linearCount += matches(text, tokens);
+        });
+        const qint64 indexed = fastest(runs, [&]() {
+            QList<int> rows;
+            indexCount = 0;
+            if (!index.lookup(tokens, rows)) { // too short, filter() falls back to scanning
+                for (const QString &text : texts)
+                    indexCount += matches(text, tokens);
+                return;
+            }
+            for (int row : rows) // the candidates still have to be verified
+                indexCount += matches(texts.at(row), tokens);
+        });
+        if (linearCount != indexCount)
+            qWarning("%s: %d linear, but %d through the index", qPrintable(needle), linearCount, indexCount);
+        printf("%-30s %10d %8.2f ms %8.2f ms\n", qPrintable(QString("\"%1\"").arg(needle)), linearCount, linear/1e6, indexed/1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,6 @@
+HEADERS = ../../trigramindex.h
+SOURCES = trigram.cpp ../../trigramindex.cpp
+INCLUDEPATH += ../..
+QT      -= gui
+CONFIG  += console
+TARGET  = trigram
@@ -0,0 +1,112 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <algorithm>
+
+#include "trigramindex.h"
+
+static inline quint64 trigram(const QString &folded, int i) {
+    return (quint64(folded.at(i).unicode()) << 32) | (quint64(folded.at(i+1).unicode()) << 16) | folded.at(i+2).unicode();
+}
+
+static QString folded(QStringView text) {
+    QString s(text.size(), Qt::Uninitialized);
+    for (int i = 0; i < text.size(); ++i)
+        s[i] = text.at(i).toCaseFolded();
+    return s;
+}
+
+static inline void appendVarint(QByteArray &data, quint32 v) {
+    while (v > 0x7f) {
+        data.append(char(0x80 | (v & 0x7f)));
+        v >>= 7;
+    }
+    data.append(char(v));
+}
+
+static inline quint32 readVarint(const uchar *&p) {
+    quint32 v = 0;
+    for (int shift = 0; ; shift += 7) {
+        const uchar b = *p++;
+        v |= quint32(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+}
+
+TrigramIndex::TrigramIndex() : m_count(0) {
+}
+
+void TrigramIndex::append(QStringView text) {
+    const int row = m_count++;
+    const QString s = folded(text);
+    for (int i = 0; i + 2 < s.size(); ++i) {
+        Posting &posting = m_postings[trigram(s, i)];
+        if (posting.last == row)
+            continue; // repeated in this row
+        appendVarint(posting.rows, row - posting.last);
+        posting.last = row;
+        ++posting.count;
+    }
+}
+
+void TrigramIndex::clear() {
+    m_postings.clear();
+    m_count = 0;
+}
+
+bool TrigramIndex::lookup(const QStringList &tokens, QList<int> &rows) const {
+    QList<const Posting*> postings;
+    for (const QString &token : tokens) {
+        const QString s = folded(token);
+        for (int i = 0; i + 2 < s.size(); ++i) {
+            const auto it = m_postings.constFind(trigram(s, i));
+            if (it == m_postings.cend()) {
+                rows.clear();
+                return true; // nothing has it
+            }
+            postings << &it.value();
+        }
+    }
+    if (postings.isEmpty())
+        return false;
+    // start with the rarest, the intersection can only shrink
+    std::sort(postings.begin(), postings.end(), [](const Posting *a, const Posting *b) { return a->count < b->count; });
+    rows.clear();
+    rows.reserve(postings.first()->count);
+    const uchar *p = reinterpret_cast<const uchar*>(postings.first()->rows.constData());
+    for (int i = 0, row = -1; i < postings.first()->count; ++i)
+        rows << (row += readVarint(p));
+    for (int j = 1; j < postings.size() && !rows.isEmpty(); ++j) {
+        const Posting *posting = postings.at(j);
+        const uchar *p = reinterpret_cast<const uchar*>(posting->rows.constData());
+        int kept = 0, row = -1, read = 0;
+        for (int i = 0; i < rows.size(); ++i) {
+            while (row < rows.at(i) && read < posting->count) {
+                row += readVarint(p);
+                ++read;
+            }
+            if (row == rows.at(i))
+                rows[kept++] = row;
+            else if (row < rows.at(i))
+                break; // posting exhausted
+        }
+        rows.resize(kept);
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+/*
+ *   Qiq shell for Qt6
+ *   Copyright 2025 by Thomas Lübking <thomas.luebking@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+
+// Case insensitive posting lists of the three character sequences in a list of strings
+// The rows are delta/varint encoded, about a byte per trigram and row
+// lookup() yields the rows that can contain all tokens, the caller still has to verify them
+class TrigramIndex {
+public:
+    TrigramIndex();
+    void append(QStringView text); // the next row
+    void clear();
+    int count() const { return m_count; }
+    bool lookup(const QStringList &tokens, QList<int> &rows) const; // false if no token has three characters
+private:
+    struct Posting {
+        QByteArray rows;
+        int last = -1;
+        int count = 0;
+    };
+    QHash<quint64, Posting> m_postings;
+    int m_count;
+};
+
+#endif // TRIGRAMINDEX_H